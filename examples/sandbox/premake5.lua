@@ -33,7 +33,7 @@ project "sandbox"
     buildoutputs { "%{cfg.targetdir}/assets_copied.stamp" }
 
     filter "configurations:Debug"
-        defines { "DEBUG" }
+        defines { "DEBUG", "VAL_PROFILING" }
         symbols "On"
 
     filter "configurations:Release"
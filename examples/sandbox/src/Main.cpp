@@ -20,7 +20,9 @@
 #include <glm/mat4x4.hpp>
 
 #include <cassert>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 #include <span>
 #include <ranges>
@@ -31,29 +33,32 @@
 #include <val/ShaderModule.h>
 #include <val/ShaderStage.h>
 #include <val/ShaderProgram.h>
-#include <val/RenderPass.h>
-#include <val/Framebuffer.h>
 #include <val/CommandPool.h>
+#include <val/CommandBundle.h>
 #include <val/Buffer.h>
+#include <val/Uploader.h>
+#include <val/SubmissionService.h>
+#include <val/GpuFuture.h>
 #include <val/DescriptorSetLayout.h>
 #include <val/DescriptorPool.h>
 #include <val/DescriptorSet.h>
-#include <val/sync/Fence.h>
-#include <val/sync/Semaphore.h>
+#include <val/FrameScheduler.h>
 #include <val/GraphicsPipeline.h>
+#include <val/PipelineLibrary.h>
+#include <val/RenderGraph.h>
+#include <val/GpuProfiler.h>
 #include <val/utils/ShaderUtils.h>
 #include <val/utils/DeviceManager.h>
+#include <val/utils/CpuProfiler.h>
 
 namespace
 {
 	struct FrameData
 	{
-		val::CommandBuffer& commandBuffer;
+		std::unique_ptr<val::RenderGraph> renderGraph;
+		std::unique_ptr<val::CommandBundle> staticBundle;
 		val::Buffer& ubo;
 		val::DescriptorSet& descriptorSet;
-		std::unique_ptr<val::sync::Semaphore> imageAvailableSemaphore;
-		std::unique_ptr<val::sync::Semaphore> renderFinishedSemaphore;
-		std::unique_ptr<val::sync::Fence> inFlightFence;
 	};
 
 	struct Vertex
@@ -185,7 +190,19 @@ int RunVulkan(GLFWwindow* window)
 
 	// Retrieve the most suited device
 	val::Device& device = deviceManager->GetSuitableDevice();
-	device.CreateLogicalDevice(instance->GetValidationLayers());
+	// Pipelines compiled by previous runs are loaded from disk, skipping their compilation
+	device.CreateLogicalDevice(instance->GetValidationLayers(), "pipeline_cache.bin");
+
+	// Coroutines awaiting GPU work are resumed on the reactor thread, so queues they submit to are owned by submission services:
+	// every call to these queues (including the render graph and frame scheduler ones) is forwarded to the service threads.
+	auto graphicsSubmissionService = std::make_unique<val::SubmissionService>(device.GetGraphicsQueue());
+	std::unique_ptr<val::SubmissionService> transferSubmissionService;
+
+	// The transfer queue may be the graphics one (a queue can only have one service)
+	if (&device.GetTransferQueue() != &device.GetGraphicsQueue())
+	{
+		transferSubmissionService = std::make_unique<val::SubmissionService>(device.GetTransferQueue());
+	}
 
 	// Create vertex module
 	auto vertexModule = std::make_unique<val::ShaderModule>(
@@ -207,28 +224,6 @@ int RunVulkan(GLFWwindow* window)
 		fragmentStage
 	});
 
-	// Create a CPU-side buffer to hold vertices
-	auto hostVertexBuffer = std::make_unique<val::Buffer>(
-		device,
-		val::BufferDesc{
-			.size = sizeof(k_vertices),
-			.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-		}
-	);
-	hostVertexBuffer->Allocate(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	hostVertexBuffer->Upload(k_vertices.data());
-
-	// Create a CPU-side buffer to hold indices
-	std::unique_ptr<val::Buffer> hostIndexBuffer = std::make_unique<val::Buffer>(
-		device,
-		val::BufferDesc{
-			.size = sizeof(k_indices),
-			.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
-		}
-	);
-	hostIndexBuffer->Allocate(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-	hostIndexBuffer->Upload(k_indices.data());
-
 	// Create a GPU-side buffer to hold vertices
 	std::unique_ptr<val::Buffer> deviceVertexBuffer = std::make_unique<val::Buffer>(
 		device,
@@ -267,21 +262,19 @@ int RunVulkan(GLFWwindow* window)
 		GetWindowSize(window)
 	);
 
-	// Create a render pass
-	auto renderPass = std::make_unique<val::RenderPass>(
-		device.GetLogicalDevice(),
-		swapChainOptimalConfig.surfaceFormat.format
-	);
+	// Pipelines are requested from a library, which returns the existing pipeline for identical descriptions
+	auto pipelineLibrary = std::make_unique<val::PipelineLibrary>(device);
 
-	// Create a graphics pipeline
-	auto graphicsPipeline = std::make_unique<val::GraphicsPipeline>(
-		device.GetLogicalDevice(),
+	// Create a graphics pipeline, rendering directly to the swap chain format (dynamic rendering, no render pass needed).
+	// The pipeline is compiled on a background thread, while the rest of the application is initialized.
+	const val::PipelineLibrary::Handle graphicsPipelineHandle = pipelineLibrary->RequestAsync(
 		val::GraphicsPipelineDesc{
 			.program = program,
-			.renderPass = *renderPass,
 			.vertexInputAttributeDesc = VertexInputDescription<Vertex>::GetAttributeDescriptions(),
 			.vertexInputBindingDesc = VertexInputDescription<Vertex>::GetBindingDescription(),
-			.descriptorSetLayouts = std::to_array({std::ref(*descriptorSetLayout)})
+			.descriptorSetLayouts = std::to_array({std::ref(*descriptorSetLayout)}),
+			.colorAttachmentFormats = std::to_array({ swapChainOptimalConfig.surfaceFormat.format }),
+			.dynamicStates = std::to_array<VkDynamicState>({ VK_DYNAMIC_STATE_CULL_MODE }) // The same pipeline can be used with any cull mode
 		}
 	);
 
@@ -292,14 +285,11 @@ int RunVulkan(GLFWwindow* window)
 		swapChainOptimalConfig
 	);
 
-	// Create framebuffers for each image in the swap chain
-	auto framebuffers = swapChain->CreateFramebuffers(renderPass->GetHandle());
-
 	// Sets how many frames we can handle (2 = double buffering, 3 = triple buffering, etc.)
 	constexpr uint8_t k_maxFramesInFlight = 2;
 
 	// Make sure the swap chain support the requested k_maxFramesInFlight
-	assert(framebuffers.size() >= k_maxFramesInFlight);
+	assert(swapChain->GetImages().size() >= k_maxFramesInFlight);
 
 	// Create UBOs (one for each frame)
 	std::vector<val::Buffer> ubos;
@@ -335,22 +325,27 @@ int RunVulkan(GLFWwindow* window)
 		);
 	}
 
-	// Create a command pool so we can create command buffers, and allocate command buffers for transfer and graphics operations.
+	// Create a command pool so we can create command buffers.
+	// Graphics command buffers are owned by the render graphs, and static content bundles are allocated from this pool.
 	auto commandPool = std::make_unique<val::CommandPool>(device);
-	std::vector<std::reference_wrapper<val::CommandBuffer>> commandBuffers = commandPool->AllocateCommandBuffers(k_maxFramesInFlight);
-	val::CommandBuffer& transferCommandBuffer = commandPool->AllocateCommandBuffers(1).front().get();
-
-	// Upload CPU (host) buffers to the GPU (device)
-	transferCommandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-	transferCommandBuffer.CopyBuffer(*hostVertexBuffer, *deviceVertexBuffer);
-	transferCommandBuffer.CopyBuffer(*hostIndexBuffer, *deviceIndexBuffer);
-	transferCommandBuffer.End();
-	device.GetGraphicsQueue().Submit({ transferCommandBuffer });
-	device.WaitIdle();
 
-	// At this point we don't need the client copy of these buffers anymore
-	hostVertexBuffer->Deallocate();
-	hostIndexBuffer->Deallocate();
+	// Upload vertices and indices to the GPU (device) buffers, using the transfer queue.
+	// The uploader hands the buffers over to the graphics queue, in the state they will be used in next.
+	auto uploader = std::make_unique<val::Uploader>(device);
+
+	// Written as a coroutine: indices are uploaded from the reactor thread once vertices are uploaded, which is only safe
+	// because the queues used by the uploader are owned by submission services.
+	auto uploadGeometry = [&]() -> val::GpuTask {
+		uploader->UploadBuffer(*deviceVertexBuffer, k_vertices.data(), sizeof(k_vertices), { VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT });
+		co_await val::GpuFuture(uploader->Flush(), device.GetReactor());
+
+		uploader->UploadBuffer(*deviceIndexBuffer, k_indices.data(), sizeof(k_indices), { VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT });
+		co_await val::GpuFuture(uploader->Flush(), device.GetReactor());
+	};
+
+	// Only wait for the uploads to complete (instead of the whole device), then release the staging buffers
+	uploadGeometry().Wait();
+	uploader.reset();
 
 	// Prepare frame data with references to the correct resources each frame will need.
 	std::vector<FrameData> frameDataArray;
@@ -358,15 +353,39 @@ int RunVulkan(GLFWwindow* window)
 	for (uint8_t i = 0; i < k_maxFramesInFlight; ++i)
 	{
 		frameDataArray.emplace_back(
-			commandBuffers[i],
+			std::make_unique<val::RenderGraph>(device),
+			std::make_unique<val::CommandBundle>(
+				*commandPool,
+				val::CommandBundleDesc{
+					.colorAttachmentFormats = std::to_array({ swapChainOptimalConfig.surfaceFormat.format })
+				}
+			),
 			ubos[i],
-			descriptorSets[i],
-			std::make_unique<val::sync::Semaphore>(device.GetLogicalDevice()),
-			std::make_unique<val::sync::Semaphore>(device.GetLogicalDevice()),
-			std::make_unique<val::sync::Fence>(device.GetLogicalDevice(), true)
+			descriptorSets[i]
 		);
 	}
 
+	// Paces frames in flight, and owns the semaphores used to acquire and present swap chain images
+	auto frameScheduler = std::make_unique<val::FrameScheduler>(
+		device,
+		*swapChain,
+		val::FrameSchedulerDesc{
+			.framesInFlight = k_maxFramesInFlight
+		}
+	);
+
+	// Measures GPU time spent in each pass (one query pool per frame in flight)
+	auto gpuProfiler = std::make_unique<val::GpuProfiler>(device, k_maxFramesInFlight);
+
+	// The pipeline should be ready by now, otherwise, wait for its compilation to complete
+	graphicsPipelineHandle.Wait();
+
+	if (graphicsPipelineHandle.HasFailed())
+	{
+		throw std::runtime_error("failed to create graphics pipeline!");
+	}
+
+	val::GraphicsPipeline& graphicsPipeline = graphicsPipelineHandle.Get();
 
 	auto recreateSwapChain = [&] {
 		VkExtent2D windowSize{ 0, 0 };
@@ -385,39 +404,37 @@ int RunVulkan(GLFWwindow* window)
 			windowSize
 		);
 
-		device.WaitIdle();
-
-		framebuffers.clear();
-		swapChain.reset();
-
-		// Recreate the swapchain
-		swapChain = std::make_unique<val::SwapChain>(
+		// Recreate the swapchain. The previous one is retired, and destroyed by the frame scheduler once its presentations
+		// are complete, so there is no need to wait for the whole device to be idle.
+		auto newSwapChain = std::make_unique<val::SwapChain>(
 			device,
 			surface->GetHandle(),
-			swapChainOptimalConfig
+			swapChainOptimalConfig,
+			*swapChain
 		);
 
-		framebuffers = swapChain->CreateFramebuffers(renderPass->GetHandle());
+		frameScheduler->SetSwapChain(*newSwapChain, std::move(swapChain));
+
+		swapChain = std::move(newSwapChain);
 	};
 
-	// The swap image index may differ from the current frame index.
-	// The frame index is totally predictible (currentFrameIndex = (previousFrameIndex + 1) % k_maxFramesInFlight)
-	// While the swap image index is returned by swapChain->AcquireNextImage()
-	uint32_t swapImageIndex = 0;
-	uint8_t currentFrameIndex = 0;
+	// The pipeline cache is saved on shutdown, but also periodically, in case the application doesn't exit gracefully
+	constexpr uint64_t k_pipelineCacheSaveInterval = 10000;
 
 	while (!glfwWindowShouldClose(window))
 	{
-		glfwPollEvents();
+		VAL_PROFILE_SCOPE("Frame");
 
-		FrameData& frameData = frameDataArray[currentFrameIndex];
-		val::CommandBuffer& commandBuffer = frameData.commandBuffer;
+		glfwPollEvents();
 
-		device.WaitForFences({ *frameData.inFlightFence });
+		// Waits for the frame slot to be released by the GPU, and acquires the next swap chain image.
+		// The swap image index may differ from the frame index: the frame index is totally predictible
+		// (frameIndex = frameNumber % k_maxFramesInFlight), while the swap image index is returned by the swap chain.
+		std::optional<std::reference_wrapper<const val::FrameContext>> beginFrameResult;
 
 		try
 		{
-			uint32_t swapImageIndex = swapChain->AcquireNextImage(*frameData.imageAvailableSemaphore);
+			beginFrameResult = frameScheduler->BeginFrame();
 		}
 		catch (val::OutOfDateSwapChain)
 		{
@@ -425,10 +442,19 @@ int RunVulkan(GLFWwindow* window)
 			continue;
 		}
 
-		device.ResetFences({ *frameData.inFlightFence });
+		const val::FrameContext& frame = beginFrameResult->get();
+		FrameData& frameData = frameDataArray[frame.frameIndex];
+		val::RenderGraph& renderGraph = *frameData.renderGraph;
+
+		// The frame timeline guarantees that the timestamps previously written for this frame are available
+		gpuProfiler->BeginFrame();
+
+		val::Image& swapChainImage = frame.swapChainImage;
+		const VkImageView swapChainImageView = frame.swapChainImageView;
 
-		// Swap Image Index might not always match the currentFrameIndex.
-		val::Framebuffer& framebuffer = framebuffers[swapImageIndex];
+		// The previous content of the swap chain image is discarded. Its state is reset so the first transition waits for
+		// the image to be acquired (the acquire semaphore is waited on at the color attachment output stage).
+		swapChainImage.SetState({ VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED });
 
 		const float time = static_cast<float>(glfwGetTime());
 
@@ -446,69 +472,106 @@ int RunVulkan(GLFWwindow* window)
 
 		frameData.ubo.Upload(&uboData);
 
-		commandBuffer.Reset();
-		commandBuffer.Begin();
-
-		commandBuffer.BeginRenderPass(
-			renderPass->GetHandle(),
-			framebuffer.GetHandle(),
-			swapChain->GetDesc().extent
-		);
-
-		commandBuffer.BindPipeline(
-			VK_PIPELINE_BIND_POINT_GRAPHICS,
-			graphicsPipeline->GetHandle()
-		);
-
-		// As noted in the fixed functions chapter, we did specify viewport and scissor state for this pipeline to be dynamic.
-		// So we need to set them in the command buffer before issuing our draw command:
-		commandBuffer.SetViewport({
-			.x = 0.0f,
-			.y = 0.0f,
-			.width = static_cast<float>(swapChain->GetDesc().extent.width),
-			.height = static_cast<float>(swapChain->GetDesc().extent.height),
-			.minDepth = 0.0f,
-			.maxDepth = 1.0f
-		});
-
-		commandBuffer.SetScissor({
-			.offset = { 0, 0 },
-			.extent = swapChain->GetDesc().extent
-		});
-
-		commandBuffer.BindVertexBuffers(
-			std::to_array({ std::ref(*deviceVertexBuffer) }),
-			std::to_array<uint64_t>({0})
-		);
-
-		commandBuffer.BindIndexBuffer(
-			*deviceIndexBuffer
+		// The static geometry is recorded once, and only recorded again when the swap chain extent changes (viewport and scissor),
+		// or when the pipeline library replaces the fast-linked pipeline with its optimized version (bound pipeline).
+		// There is one bundle per frame in flight, since each frame binds its own descriptor set.
+		const VkExtent2D extent = swapChain->GetDesc().extent;
+		frameData.staticBundle->Update({ extent.width, extent.height, graphicsPipeline.IsOptimized() },
+			[&](val::CommandBuffer& p_commandBuffer) {
+				p_commandBuffer.BindPipeline(graphicsPipeline);
+
+				// As noted in the fixed functions chapter, we did specify viewport and scissor state for this pipeline to be dynamic.
+				// So we need to set them in the command buffer before issuing our draw command:
+				p_commandBuffer.SetViewport({
+					.x = 0.0f,
+					.y = 0.0f,
+					.width = static_cast<float>(extent.width),
+					.height = static_cast<float>(extent.height),
+					.minDepth = 0.0f,
+					.maxDepth = 1.0f
+				});
+
+				p_commandBuffer.SetScissor({
+					.offset = { 0, 0 },
+					.extent = extent
+				});
+
+				p_commandBuffer.SetCullMode(VK_CULL_MODE_BACK_BIT);
+
+				p_commandBuffer.BindVertexBuffers(
+					std::to_array({ std::ref(*deviceVertexBuffer) }),
+					std::to_array<uint64_t>({0})
+				);
+
+				p_commandBuffer.BindIndexBuffer(
+					*deviceIndexBuffer
+				);
+
+				p_commandBuffer.BindDescriptorSets(
+					std::to_array({ std::ref(frameData.descriptorSet) }),
+					graphicsPipeline.GetLayout()
+				);
+
+				p_commandBuffer.DrawIndexed(static_cast<uint32_t>(k_indices.size()));
+			}
 		);
 
-		commandBuffer.BindDescriptorSets(
-			std::to_array({ std::ref(frameData.descriptorSet) }),
-			graphicsPipeline->GetLayout()
+		// The render graph is reset every frame, since the frame content may change (the graph is cheap to rebuild).
+		// At this point, the frame timeline guarantees that the previous execution of this graph is complete.
+		renderGraph.Reset();
+
+		const val::RenderGraphResource vertexBufferResource = renderGraph.ImportBuffer(*deviceVertexBuffer);
+		const val::RenderGraphResource indexBufferResource = renderGraph.ImportBuffer(*deviceIndexBuffer);
+		const val::RenderGraphResource swapChainImageResource = renderGraph.ImportImage(swapChainImage);
+
+		renderGraph.AddPass("Main", val::EQueueType::Graphics,
+			[&](val::RenderGraphPassBuilder& p_builder) {
+				p_builder.Read(vertexBufferResource, { VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT });
+				p_builder.Read(indexBufferResource, { VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT });
+				p_builder.Write(swapChainImageResource, { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+			},
+			[&](val::CommandBuffer& p_commandBuffer) {
+				gpuProfiler->BeginScope(p_commandBuffer, "Main");
+
+				const VkRenderingAttachmentInfo colorAttachment{
+					.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+					.imageView = swapChainImageView,
+					.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+					.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+					.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+					.clearValue = { .color = { .float32 = { 0.0f, 0.0f, 0.0f, 1.0f } } }
+				};
+
+				p_commandBuffer.BeginRendering(
+					std::to_array({ colorAttachment }),
+					std::nullopt,
+					extent,
+					VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT
+				);
+
+				p_commandBuffer.ExecuteCommands(std::to_array({ std::ref(frameData.staticBundle->GetCommandBuffer()) }));
+
+				p_commandBuffer.EndRendering();
+
+				gpuProfiler->EndScope(p_commandBuffer);
+			}
 		);
 
-		commandBuffer.DrawIndexed(static_cast<uint32_t>(k_indices.size()));
+		// The swap chain image is presented once the graph completes
+		renderGraph.MarkAsOutput(swapChainImageResource, val::sync::ResourceState{ .layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR });
 
-		commandBuffer.EndRenderPass();
-		commandBuffer.End();
+		renderGraph.Compile();
 
-		device.GetGraphicsQueue().Submit(
-			{ commandBuffer },
-			{ *frameData.imageAvailableSemaphore },
-			{ *frameData.renderFinishedSemaphore },
-			* frameData.inFlightFence
+		renderGraph.Execute(
+			{ frame.imageAvailableSemaphore },
+			{ frame.renderFinishedSemaphore },
+			{},
+			{ frame.completionValue }
 		);
 
 		try
 		{
-			device.GetPresentQueue().Present(
-				{ *frameData.renderFinishedSemaphore },
-				*swapChain,
-				swapImageIndex
-			);
+			frameScheduler->EndFrame();
 		}
 		catch (val::OutOfDateSwapChain)
 		{
@@ -516,7 +579,10 @@ int RunVulkan(GLFWwindow* window)
 			continue;
 		}
 
-		currentFrameIndex = (currentFrameIndex + 1) % k_maxFramesInFlight;
+		if (frameScheduler->GetFrameNumber() % k_pipelineCacheSaveInterval == 0 && !device.GetPipelineCache().Save())
+		{
+			std::cerr << "failed to save the pipeline cache" << std::endl;
+		}
 	}
 
 	// Operations in drawFrame are asynchronous. That means that when we exit the loop in mainLoop,
@@ -525,6 +591,13 @@ int RunVulkan(GLFWwindow* window)
 	// To fix that problem, we should wait for the logical device to finish operations before exiting mainLoop and destroying the window.
 	device.WaitIdle();
 
+	// Can be loaded in chrome://tracing or Perfetto
+	std::ofstream("gpu_trace.json") << gpuProfiler->ExportChromeTrace();
+
+#if defined(VAL_PROFILING)
+	std::ofstream("cpu_trace.json") << val::utils::CpuProfiler::ExportChromeTrace();
+#endif
+
 	return EXIT_SUCCESS;
 }
 
@@ -8,6 +8,7 @@
 
 #include <vulkan/vulkan.h>
 #include <optional>
+#include <val/sync/ResourceState.h>
 
 namespace val
 {
@@ -68,10 +69,25 @@ namespace val
 		*/
 		VkBuffer GetHandle() const;
 
+		/**
+		* Returns the last known GPU state of the buffer (stage and access)
+		*/
+		const sync::ResourceState& GetState() const;
+
+		/**
+		* Overrides the last known GPU state of the buffer.
+		* @note CommandBuffer updates this state automatically when recording commands using the buffer
+		*/
+		void SetState(const sync::ResourceState& p_state);
+
+	private:
+		friend class CommandBuffer;
+
 	private:
 		Device& m_device;
 		VkBuffer m_handle = VK_NULL_HANDLE;
 		VkDeviceMemory m_memory = VK_NULL_HANDLE;
 		uint64_t m_allocatedBytes = 0;
+		sync::ResourceState m_state;
 	};
 }
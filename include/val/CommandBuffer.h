@@ -9,16 +9,27 @@
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <span>
+#include <optional>
+#include <type_traits>
+#include <val/sync/BarrierBatch.h>
 
 namespace val
 {
 	class CommandPool;
+	class Device;
 	class Buffer;
+	class Image;
 	class DescriptorSet;
+	class GraphicsPipeline;
+	class ComputePipeline;
+	class QueryPool;
 
 	class CommandBuffer
 	{
 	public:
+		// Minimum push constants size guaranteed by the Vulkan specification (maxPushConstantsSize)
+		static constexpr uint32_t k_maxPushConstantsSize = 128;
+
 		/**
 		* Destroys the command buffer
 		*/
@@ -39,18 +50,73 @@ namespace val
 		*/
 		void Begin(VkCommandBufferUsageFlags p_flags = 0);
 
+		/**
+		* Begin recording commands of a secondary command buffer, inheriting the given render pass (or rendering) state
+		* @note if VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT is set, the command buffer is considered inside a render pass
+		*/
+		void Begin(VkCommandBufferUsageFlags p_flags, const VkCommandBufferInheritanceInfo& p_inheritanceInfo);
+
 		/**
 		* Finish recording commands
+		* @note pending barriers are flushed before the recording ends
 		*/
 		void End();
 
+		/**
+		* Requests a buffer to be in the given state for the upcoming commands.
+		* The required barrier (if any) is batched, and emitted before the next draw, copy or render pass.
+		*/
+		void TransitionBuffer(Buffer& p_buffer, const sync::ResourceState& p_state);
+
+		/**
+		* Requests an image to be in the given state (and layout) for the upcoming commands.
+		* The required barrier (if any) is batched, and emitted before the next draw, copy or render pass.
+		*/
+		void TransitionImage(Image& p_image, const sync::ResourceState& p_state);
+
+		/**
+		* Releases the ownership of a buffer to another queue family (first half of an ownership transfer).
+		* The command buffer must be submitted to a queue of the source family, before the matching acquire.
+		* @note if both families are identical, no barrier is needed and the buffer is left untouched
+		*/
+		void ReleaseBufferOwnership(Buffer& p_buffer, uint32_t p_srcQueueFamilyIndex, uint32_t p_dstQueueFamilyIndex);
+
+		/**
+		* Acquires the ownership of a buffer released by another queue family (second half of an ownership transfer),
+		* and transitions it to the given state.
+		* The command buffer must be submitted to a queue of the destination family, after the matching release
+		* (e.g. by waiting for a semaphore signaled by the release submission).
+		* @note if both families are identical, this is equivalent to TransitionBuffer()
+		*/
+		void AcquireBufferOwnership(
+			Buffer& p_buffer,
+			uint32_t p_srcQueueFamilyIndex,
+			uint32_t p_dstQueueFamilyIndex,
+			const sync::ResourceState& p_state
+		);
+
+		/**
+		* Enables or disables automatic resource state tracking (enabled by default).
+		* When disabled, transitions requested by this command buffer are ignored, and resource states aren't updated.
+		* @note useful when barriers are computed ahead of time by an external scheduler (e.g. RenderGraph)
+		*/
+		void SetResourceStateTracking(bool p_enabled);
+
+		/**
+		* Emits all pending barriers using a single vkCmdPipelineBarrier2 call
+		* @note barriers cannot be emitted inside of a render pass
+		*/
+		void FlushBarriers();
+
 		/**
 		* Begin a render pass
+		* @note pending barriers are flushed before the render pass begins
 		*/
 		void BeginRenderPass(
 			VkRenderPass p_renderPass,
 			VkFramebuffer p_framebuffer,
-			VkExtent2D p_extent
+			VkExtent2D p_extent,
+			VkSubpassContents p_contents = VK_SUBPASS_CONTENTS_INLINE
 		);
 
 		/**
@@ -58,6 +124,77 @@ namespace val
 		*/
 		void EndRenderPass();
 
+		/**
+		* Begin rendering to the given attachments, without render pass and framebuffer objects (VK_KHR_dynamic_rendering)
+		* @note pending barriers are flushed before the rendering begins
+		*/
+		void BeginRendering(
+			std::span<const VkRenderingAttachmentInfo> p_colorAttachments,
+			std::optional<VkRenderingAttachmentInfo> p_depthAttachment,
+			VkExtent2D p_extent,
+			VkRenderingFlags p_flags = 0
+		);
+
+		/**
+		* End rendering
+		*/
+		void EndRendering();
+
+		/**
+		* Execute secondary command buffers
+		* @note the render pass (or rendering) must have been started with secondary command buffer contents
+		*/
+		void ExecuteCommands(std::span<const std::reference_wrapper<CommandBuffer>> p_commandBuffers);
+
+		/**
+		* Resets a range of queries from the GPU timeline
+		* @note must be recorded outside of a render pass
+		*/
+		void ResetQueryPool(QueryPool& p_queryPool, uint32_t p_firstQuery, uint32_t p_queryCount);
+
+		/**
+		* Begins a query (e.g. occlusion or pipeline statistics)
+		* @note the query must have been reset since its last use
+		*/
+		void BeginQuery(QueryPool& p_queryPool, uint32_t p_query, VkQueryControlFlags p_flags = 0);
+
+		/**
+		* Ends a query previously started with BeginQuery()
+		*/
+		void EndQuery(QueryPool& p_queryPool, uint32_t p_query);
+
+		/**
+		* Copies query results to a buffer (e.g. occlusion results used as conditional rendering predicates)
+		* @note without VK_QUERY_RESULT_64_BIT, results are written as 32-bit values
+		*/
+		void CopyQueryPoolResults(
+			QueryPool& p_queryPool,
+			uint32_t p_firstQuery,
+			uint32_t p_queryCount,
+			Buffer& p_dest,
+			uint64_t p_destOffset,
+			uint64_t p_stride,
+			VkQueryResultFlags p_flags = 0
+		);
+
+		/**
+		* Begins a conditional rendering block: subsequent draws and dispatches are discarded by the GPU
+		* if the 32-bit value at the given buffer offset is zero (or non-zero, if inverted)
+		* @note requires conditional rendering to be supported (see Device::IsConditionalRenderingSupported())
+		* @note inside a render pass, the buffer must have been transitioned beforehand (conditional rendering read)
+		*/
+		void BeginConditionalRendering(Buffer& p_buffer, uint64_t p_offset, bool p_inverted = false);
+
+		/**
+		* Ends the current conditional rendering block
+		*/
+		void EndConditionalRendering();
+
+		/**
+		* Writes a timestamp to the given query once every previous command reaches the given stage
+		*/
+		void WriteTimestamp(QueryPool& p_queryPool, uint32_t p_query, VkPipelineStageFlags2 p_stage = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
 		/**
 		* Copy buffer content from source to destination
 		*/
@@ -68,11 +205,41 @@ namespace val
 		*/
 		void BindPipeline(VkPipelineBindPoint p_bindPoint, VkPipeline p_pipeline);
 
+		/**
+		* Bind a graphics pipeline, and keep track of its layout for upcoming push constants updates
+		*/
+		void BindPipeline(const GraphicsPipeline& p_pipeline);
+
+		/**
+		* Bind a compute pipeline, and keep track of its layout for upcoming push constants updates
+		*/
+		void BindPipeline(const ComputePipeline& p_pipeline);
+
+		/**
+		* Update push constants of the currently bound pipeline layout
+		* @note the pipeline must be bound using BindPipeline(const GraphicsPipeline&) or BindPipeline(const ComputePipeline&)
+		*/
+		template<class T>
+		void PushConstants(VkShaderStageFlags p_stages, uint32_t p_offset, const T& p_value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "push constants must be trivially copyable");
+			static_assert(sizeof(T) % 4 == 0, "push constants size must be a multiple of 4");
+			static_assert(sizeof(T) <= k_maxPushConstantsSize, "push constants exceed the 128 bytes guaranteed by the Vulkan specification");
+
+			PushConstants(p_stages, p_offset, static_cast<uint32_t>(sizeof(T)), &p_value);
+		}
+
+		/**
+		* Update push constants of the currently bound pipeline layout, from raw data
+		* @note the pipeline must be bound using BindPipeline(const GraphicsPipeline&) or BindPipeline(const ComputePipeline&)
+		*/
+		void PushConstants(VkShaderStageFlags p_stages, uint32_t p_offset, uint32_t p_size, const void* p_data);
+
 		/**
 		* Bind index buffer
 		*/
 		void BindIndexBuffer(
-			const Buffer& p_indexBuffer,
+			Buffer& p_indexBuffer,
 			uint64_t p_offset = 0,
 			VkIndexType p_indexType = VkIndexType::VK_INDEX_TYPE_UINT32
 		);
@@ -90,7 +257,8 @@ namespace val
 		*/
 		void BindDescriptorSets(
 			std::span<const std::reference_wrapper<DescriptorSet>> p_descriptorSets,
-			VkPipelineLayout p_pipelineLayout
+			VkPipelineLayout p_pipelineLayout,
+			VkPipelineBindPoint p_bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS
 		);
 
 		/**
@@ -103,6 +271,126 @@ namespace val
 		*/
 		void SetScissor(const VkRect2D& p_scissor);
 
+		/**
+		* Set line width
+		* @note requires VK_DYNAMIC_STATE_LINE_WIDTH
+		*/
+		void SetLineWidth(float p_lineWidth);
+
+		/**
+		* Set cull mode (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_CULL_MODE
+		*/
+		void SetCullMode(VkCullModeFlags p_cullMode);
+
+		/**
+		* Set front face (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_FRONT_FACE
+		*/
+		void SetFrontFace(VkFrontFace p_frontFace);
+
+		/**
+		* Set primitive topology (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY, the topology must belong to the same class (point, line, triangle, patch) as the baked one
+		*/
+		void SetPrimitiveTopology(VkPrimitiveTopology p_topology);
+
+		/**
+		* Enable or disable depth testing (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE
+		*/
+		void SetDepthTestEnable(bool p_enabled);
+
+		/**
+		* Enable or disable depth writes (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE
+		*/
+		void SetDepthWriteEnable(bool p_enabled);
+
+		/**
+		* Set depth compare operator (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_DEPTH_COMPARE_OP
+		*/
+		void SetDepthCompareOp(VkCompareOp p_compareOp);
+
+		/**
+		* Enable or disable depth bounds testing (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_DEPTH_BOUNDS_TEST_ENABLE
+		*/
+		void SetDepthBoundsTestEnable(bool p_enabled);
+
+		/**
+		* Enable or disable stencil testing (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_STENCIL_TEST_ENABLE
+		*/
+		void SetStencilTestEnable(bool p_enabled);
+
+		/**
+		* Set stencil operations (extended dynamic state)
+		* @note requires VK_DYNAMIC_STATE_STENCIL_OP
+		*/
+		void SetStencilOp(VkStencilFaceFlags p_faceMask, VkStencilOp p_failOp, VkStencilOp p_passOp, VkStencilOp p_depthFailOp, VkCompareOp p_compareOp);
+
+		/**
+		* Enable or disable rasterizer discard (extended dynamic state 2)
+		* @note requires VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE
+		*/
+		void SetRasterizerDiscardEnable(bool p_enabled);
+
+		/**
+		* Enable or disable depth bias (extended dynamic state 2)
+		* @note requires VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE
+		*/
+		void SetDepthBiasEnable(bool p_enabled);
+
+		/**
+		* Enable or disable primitive restart (extended dynamic state 2)
+		* @note requires VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE
+		*/
+		void SetPrimitiveRestartEnable(bool p_enabled);
+
+		/**
+		* Set polygon mode (extended dynamic state 3)
+		* @note requires VK_DYNAMIC_STATE_POLYGON_MODE_EXT, and the extendedDynamicState3PolygonMode feature
+		*/
+		void SetPolygonMode(VkPolygonMode p_polygonMode);
+
+		/**
+		* Set rasterization samples (extended dynamic state 3)
+		* @note requires VK_DYNAMIC_STATE_RASTERIZATION_SAMPLES_EXT, and the extendedDynamicState3RasterizationSamples feature
+		*/
+		void SetRasterizationSamples(VkSampleCountFlagBits p_samples);
+
+		/**
+		* Enable or disable depth clamping (extended dynamic state 3)
+		* @note requires VK_DYNAMIC_STATE_DEPTH_CLAMP_ENABLE_EXT, and the extendedDynamicState3DepthClampEnable feature
+		*/
+		void SetDepthClampEnable(bool p_enabled);
+
+		/**
+		* Enable or disable logic operations (extended dynamic state 3)
+		* @note requires VK_DYNAMIC_STATE_LOGIC_OP_ENABLE_EXT, and the extendedDynamicState3LogicOpEnable feature
+		*/
+		void SetLogicOpEnable(bool p_enabled);
+
+		/**
+		* Enable or disable blending, for each color attachment starting at the given one (extended dynamic state 3)
+		* @note requires VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT, and the extendedDynamicState3ColorBlendEnable feature
+		*/
+		void SetColorBlendEnable(uint32_t p_firstAttachment, std::span<const VkBool32> p_enabled);
+
+		/**
+		* Set blend factors and operations, for each color attachment starting at the given one (extended dynamic state 3)
+		* @note requires VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT, and the extendedDynamicState3ColorBlendEquation feature
+		*/
+		void SetColorBlendEquation(uint32_t p_firstAttachment, std::span<const VkColorBlendEquationEXT> p_equations);
+
+		/**
+		* Set color write masks, for each color attachment starting at the given one (extended dynamic state 3)
+		* @note requires VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT, and the extendedDynamicState3ColorWriteMask feature
+		*/
+		void SetColorWriteMask(uint32_t p_firstAttachment, std::span<const VkColorComponentFlags> p_masks);
+
 		/**
 		* Submit a draw command
 		*/
@@ -113,13 +401,24 @@ namespace val
 		*/
 		void DrawIndexed(uint32_t p_indexCount, uint32_t p_instanceCount = 1);
 
+		/**
+		* Submit a compute dispatch command
+		* @note pending barriers are flushed before the dispatch
+		*/
+		void Dispatch(uint32_t p_groupCountX, uint32_t p_groupCountY = 1, uint32_t p_groupCountZ = 1);
+
 
 	private:
-		CommandBuffer(VkCommandBuffer p_handle);
+		CommandBuffer(Device& p_device, VkCommandBuffer p_handle);
 
 		friend class CommandPool;
 
 	private:
+		Device& m_device;
 		VkCommandBuffer m_handle = VK_NULL_HANDLE;
+		sync::BarrierBatch m_pendingBarriers;
+		bool m_insideRenderPass = false;
+		bool m_resourceStateTracking = true;
+		VkPipelineLayout m_boundPipelineLayout = VK_NULL_HANDLE;
 	};
 }
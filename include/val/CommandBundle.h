@@ -0,0 +1,85 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace val
+{
+	class CommandPool;
+	class CommandBuffer;
+	class RenderPass;
+
+	struct CommandBundleDesc
+	{
+		std::optional<std::reference_wrapper<RenderPass>> renderPass = std::nullopt;
+		uint32_t subpass = 0;
+		std::span<const VkFormat> colorAttachmentFormats;
+		VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED;
+	};
+
+	/**
+	* Secondary command buffer recorded once and replayed every frame (e.g. for static geometry).
+	* The bundle is only re-recorded when its inputs change.
+	* @note if no render pass is provided, the bundle is executed within dynamic rendering,
+	* using the given attachment formats
+	*/
+	class CommandBundle
+	{
+	public:
+		using RecordCallback = std::function<void(CommandBuffer&)>;
+
+		/**
+		* Creates a command bundle, allocating its secondary command buffer from the given command pool
+		*/
+		CommandBundle(CommandPool& p_commandPool, const CommandBundleDesc& p_desc);
+
+		/**
+		* Destroys the command bundle
+		*/
+		virtual ~CommandBundle() = default;
+
+		/**
+		* Records the bundle if it has never been recorded, if it has been invalidated, or if the given inputs
+		* differ from the ones used for the previous recording. Returns true if the bundle has been recorded.
+		* @note inputs are arbitrary values identifying what the recorded commands depend on (handles, extent, etc.)
+		* @note the bundle must not be in use by the GPU when it is recorded again
+		* @note resources used by the bundle must be transitioned by the primary command buffer beforehand,
+		* since resource state tracking is disabled while recording a bundle
+		*/
+		bool Update(std::initializer_list<uint64_t> p_inputs, const RecordCallback& p_record);
+
+		/**
+		* Forces the bundle to be recorded again on the next update
+		*/
+		void Invalidate();
+
+		/**
+		* Returns true if the bundle has been recorded, and hasn't been invalidated since
+		*/
+		bool IsValid() const;
+
+		/**
+		* Returns the secondary command buffer of the bundle, to be executed by a primary command buffer
+		*/
+		CommandBuffer& GetCommandBuffer() const;
+
+	private:
+		CommandBuffer& m_commandBuffer;
+		std::optional<std::reference_wrapper<RenderPass>> m_renderPass;
+		uint32_t m_subpass;
+		std::vector<VkFormat> m_colorAttachmentFormats;
+		VkFormat m_depthAttachmentFormat;
+		std::vector<uint64_t> m_inputs;
+		bool m_valid = false;
+	};
+}
@@ -9,6 +9,7 @@
 #include <vulkan/vulkan.h>
 #include <list>
 #include <vector>
+#include <val/Queue.h>
 
 namespace val
 {
@@ -19,9 +20,9 @@ namespace val
 	{
 	public:
 		/**
-		* Creates a command pool
+		* Creates a command pool, allocating command buffers for the queue family used by the given queue type
 		*/
-		CommandPool(Device& p_device);
+		CommandPool(Device& p_device, EQueueType p_queueType = EQueueType::Graphics);
 
 		/**
 		* Destroys the command pool
@@ -38,9 +39,15 @@ namespace val
 		*/
 		VkCommandPool GetHandle() const;
 
+		/**
+		* Returns the queue family index command buffers are allocated for
+		*/
+		uint32_t GetQueueFamilyIndex() const;
+
 	private:
 		Device& m_device;
 		VkCommandPool m_handle = VK_NULL_HANDLE;
+		uint32_t m_queueFamilyIndex;
 		std::list<CommandBuffer> m_commandBuffers;
 	};
 }
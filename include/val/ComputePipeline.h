@@ -0,0 +1,53 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <span>
+#include <val/ShaderStage.h>
+#include <val/DescriptorSetLayout.h>
+
+namespace val
+{
+	class Device;
+
+	struct ComputePipelineDesc
+	{
+		ShaderStage& stage;
+		std::span<const std::reference_wrapper<DescriptorSetLayout>> descriptorSetLayouts;
+		std::span<const VkPushConstantRange> pushConstantRanges;
+	};
+
+	class ComputePipeline
+	{
+	public:
+		/**
+		* Creates a compute pipeline, using the pipeline cache of the given device
+		*/
+		ComputePipeline(Device& p_device, const ComputePipelineDesc& p_desc);
+
+		/**
+		* Destroys the compute pipeline
+		*/
+		virtual ~ComputePipeline();
+
+		/**
+		* Returns a VkPipeline handle
+		*/
+		VkPipeline GetHandle() const;
+
+		/**
+		* Returns a VkPipelineLayout handle
+		*/
+		VkPipelineLayout GetLayout() const;
+
+	private:
+		VkDevice m_device = VK_NULL_HANDLE;
+		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_computePipeline = VK_NULL_HANDLE;
+	};
+}
@@ -0,0 +1,80 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <val/sync/TimelineSemaphore.h>
+
+namespace val
+{
+	/**
+	* Defers the destruction of resources until the GPU is done with them: each deletion is keyed on a timeline value
+	* (e.g. the completion value of the current frame), and executed by Flush() once the timeline reaches it.
+	* This avoids waiting for the whole device to be idle before releasing a resource.
+	* @note timeline semaphores used as keys must outlive their pending deletions
+	* @note thread-safe
+	*/
+	class DeletionQueue
+	{
+	public:
+		using Deleter = std::function<void()>;
+
+		/**
+		* Creates an empty deletion queue
+		*/
+		DeletionQueue() = default;
+
+		/**
+		* Destroys the deletion queue, executing every pending deletion
+		* @note the device must be idle
+		*/
+		virtual ~DeletionQueue();
+
+		/**
+		* Enqueues a deletion, executed once the given timeline value is reached
+		*/
+		void Enqueue(const sync::TimelineValue& p_retireValue, Deleter p_deleter);
+
+		/**
+		* Enqueues the destruction of an object, once the given timeline value is reached
+		*/
+		template<class T>
+		void Enqueue(const sync::TimelineValue& p_retireValue, std::unique_ptr<T> p_object)
+		{
+			// std::function must be copyable, so the ownership is moved to a shared pointer
+			Enqueue(p_retireValue, [object = std::shared_ptr<T>(std::move(p_object))]() mutable {
+				object.reset();
+			});
+		}
+
+		/**
+		* Executes every deletion whose timeline value has been reached, without waiting
+		* @note called by FrameScheduler::BeginFrame(), once per frame
+		*/
+		void Flush();
+
+		/**
+		* Executes every pending deletion, without checking timelines
+		* @note the device must be idle
+		*/
+		void FlushAll();
+
+	private:
+		struct PendingDeletion
+		{
+			sync::TimelineValue retireValue;
+			Deleter deleter;
+		};
+
+	private:
+		std::mutex m_mutex;
+		std::vector<PendingDeletion> m_pendingDeletions;
+	};
+}
@@ -12,11 +12,18 @@
 #include <span>
 #include <array>
 #include <vector>
+#include <filesystem>
 #include <val/DebugMessenger.h>
 #include <val/utils/ExtensionManager.h>
 #include <val/utils/SwapChainUtils.h>
 #include <val/sync/Fence.h>
 #include <val/sync/Semaphore.h>
+#include <val/sync/TimelineSemaphore.h>
+#include <val/sync/FencePool.h>
+#include <val/sync/SemaphorePool.h>
+#include <val/sync/WaitStrategy.h>
+#include <val/DeletionQueue.h>
+#include <val/PipelineCache.h>
 #include <val/Queue.h>
 #include <vulkan/vulkan.h>
 
@@ -26,6 +33,8 @@ namespace val
 	{
 		std::optional<uint32_t> graphicsFamily;
 		std::optional<uint32_t> presentFamily;
+		std::optional<uint32_t> computeFamily; // Only set if a family supports compute without graphics
+		std::optional<uint32_t> transferFamily; // Only set if a family supports transfers without graphics
 
 		/**
 		* Returns true if all the required queue family are complete
@@ -33,9 +42,36 @@ namespace val
 		bool IsComplete() const;
 
 		/**
-		* Returns a contiguous array of indices
+		* Returns a contiguous array of every family used by the device (graphics, present, compute and transfer), to create its queues
+		* @note not meant for resource sharing modes: resources used by compute or transfer families are transferred
+		* explicitly (see GetPresentationQueueIndices() for swap chain images)
 		*/
 		std::vector<uint32_t> GetUniqueQueueIndices() const;
+
+		/**
+		* Returns the unique graphics and present family indices, the only families sharing swap chain images
+		*/
+		std::vector<uint32_t> GetPresentationQueueIndices() const;
+	};
+
+	/**
+	* Extension functions aren't exported by the loader, so their addresses are resolved once when the logical device is created.
+	* Functions of unsupported extensions are left null.
+	*/
+	struct DeviceDispatch
+	{
+		// VK_EXT_conditional_rendering
+		PFN_vkCmdBeginConditionalRenderingEXT vkCmdBeginConditionalRenderingEXT = nullptr;
+		PFN_vkCmdEndConditionalRenderingEXT vkCmdEndConditionalRenderingEXT = nullptr;
+
+		// VK_EXT_extended_dynamic_state3
+		PFN_vkCmdSetPolygonModeEXT vkCmdSetPolygonModeEXT = nullptr;
+		PFN_vkCmdSetRasterizationSamplesEXT vkCmdSetRasterizationSamplesEXT = nullptr;
+		PFN_vkCmdSetDepthClampEnableEXT vkCmdSetDepthClampEnableEXT = nullptr;
+		PFN_vkCmdSetLogicOpEnableEXT vkCmdSetLogicOpEnableEXT = nullptr;
+		PFN_vkCmdSetColorBlendEnableEXT vkCmdSetColorBlendEnableEXT = nullptr;
+		PFN_vkCmdSetColorBlendEquationEXT vkCmdSetColorBlendEquationEXT = nullptr;
+		PFN_vkCmdSetColorWriteMaskEXT vkCmdSetColorWriteMaskEXT = nullptr;
 	};
 
 	// TODO: Separate Physical and Logical device
@@ -74,8 +110,12 @@ namespace val
 
 		/**
 		* Creates the logical device for the current physical device
+		* @note if a pipeline cache path is given, the pipeline cache is loaded from (and saved to) this file
 		*/
-		void CreateLogicalDevice(std::vector<const char*> p_validationLayers);
+		void CreateLogicalDevice(
+			std::vector<const char*> p_validationLayers,
+			std::optional<std::filesystem::path> p_pipelineCachePath = std::nullopt
+		);
 
 		/**
 		* Returns the physical device handle
@@ -88,17 +128,120 @@ namespace val
 		*/
 		VkDevice GetLogicalDevice() const;
 
+		/**
+		* Returns the extension functions resolved for this logical device
+		* @note will assert if the device doesn't have a logical device associated
+		*/
+		const DeviceDispatch& GetDispatch() const;
+
 		/**
 		* Returns the graphics queue associated with this logical device
 		* @note will assert if the device doesn't have a logical device associated
 		*/
-		Queue GetGraphicsQueue() const;
+		Queue& GetGraphicsQueue() const;
+
+		/**
+		* Returns the present queue associated with this logical device.
+		* Same instance as the graphics queue if graphics and present share the same queue family.
+		* @note will assert if the device doesn't have a logical device associated
+		*/
+		Queue& GetPresentQueue() const;
+
+		/**
+		* Returns the compute queue associated with this logical device, used for async compute (culling, particles, post-processing...).
+		* Falls back to the graphics queue (same instance) if the device has no dedicated compute family.
+		* @note cross-queue dependencies must be expressed with semaphores
+		* @note will assert if the device doesn't have a logical device associated
+		*/
+		Queue& GetComputeQueue() const;
+
+		/**
+		* Returns the transfer queue associated with this logical device.
+		* Falls back to the graphics queue (same instance) if the device has no dedicated transfer family.
+		* Same instance as the compute queue if both share a family exposing a single queue.
+		* @note will assert if the device doesn't have a logical device associated
+		*/
+		Queue& GetTransferQueue() const;
+
+		/**
+		* Returns the pool of recycled fences owned by this logical device
+		* @note will assert if the device doesn't have a logical device associated
+		*/
+		sync::FencePool& GetFencePool() const;
+
+		/**
+		* Returns the pool of recycled binary semaphores owned by this logical device
+		* @note will assert if the device doesn't have a logical device associated
+		*/
+		sync::SemaphorePool& GetSemaphorePool() const;
+
+		/**
+		* Returns the reactor resuming coroutines awaiting GPU work (see GpuFuture)
+		* @note will assert if the device doesn't have a logical device associated
+		*/
+		GpuReactor& GetReactor() const;
+
+		/**
+		* Returns the queue of deferred deletions owned by this logical device, flushed once per frame by the FrameScheduler
+		* @note will assert if the device doesn't have a logical device associated
+		*/
+		DeletionQueue& GetDeletionQueue() const;
 
 		/**
-		* Returns the present queue associated with this logical device
+		* Returns the pipeline cache owned by this logical device, used by every pipeline creation
 		* @note will assert if the device doesn't have a logical device associated
 		*/
-		Queue GetPresentQueue() const;
+		PipelineCache& GetPipelineCache() const;
+
+		/**
+		* Returns the family index of the queue used for the given queue type
+		*/
+		uint32_t GetQueueFamilyIndex(EQueueType p_queueType) const;
+
+		/**
+		* Returns true if compute work runs on a queue family separate from graphics
+		* (in which case, resources shared with graphics need queue family ownership transfers)
+		*/
+		bool HasDedicatedComputeQueue() const;
+
+		/**
+		* Returns true if transfers run on a queue family separate from graphics
+		* (in which case, resources need queue family ownership transfers)
+		*/
+		bool HasDedicatedTransferQueue() const;
+
+		/**
+		* Returns the properties (limits, timestamp period, etc.) of the physical device
+		*/
+		const VkPhysicalDeviceProperties& GetProperties() const;
+
+		/**
+		* Returns true if conditional rendering (VK_EXT_conditional_rendering) is supported, and thus enabled
+		*/
+		bool IsConditionalRenderingSupported() const;
+
+		/**
+		* Returns true if graphics pipeline libraries (VK_EXT_graphics_pipeline_library) are supported, and thus enabled
+		*/
+		bool IsGraphicsPipelineLibrarySupported() const;
+
+		/**
+		* Returns true if extended dynamic state 3 (VK_EXT_extended_dynamic_state3) is supported, and thus enabled
+		* @note each dynamic state is an individual feature (see GetExtendedDynamicState3Features())
+		* @note extended dynamic state 1 and 2 are part of Vulkan 1.3, and always available
+		*/
+		bool IsExtendedDynamicState3Supported() const;
+
+		/**
+		* Returns true if swap chain maintenance (VK_EXT_swapchain_maintenance1) is supported, and thus enabled.
+		* It provides present fences, telling when the presentation engine is done with a present operation.
+		*/
+		bool IsSwapchainMaintenance1Supported() const;
+
+		/**
+		* Returns the extended dynamic state 3 features, telling which state can be made dynamic
+		*/
+		const VkPhysicalDeviceExtendedDynamicState3FeaturesEXT& GetExtendedDynamicState3Features() const;
 
 		/**
 		* Returns swap chain support details for this physical device
@@ -111,9 +254,10 @@ namespace val
 		const QueueFamilyIndices& GetQueueFamilyIndices() const;
 
 		/**
-		* Wait for fences
+		* Wait for fences, using the device wait strategy.
+		* Returns false if the timeout expired.
 		*/
-		void WaitForFences(
+		bool WaitForFences(
 			std::initializer_list<std::reference_wrapper<val::sync::Fence>> p_fences,
 			bool p_waitAll = true,
 			std::optional<uint64_t> p_timeout = std::nullopt
@@ -127,19 +271,38 @@ namespace val
 		);
 
 		/**
-		* Wait for semaphores
+		* Wait for timeline semaphores to reach the given values (all of them, or any of them), using the device wait strategy.
+		* Returns false if the timeout expired.
 		*/
-		void WaitForSemaphores(
-			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_semaphores,
+		bool WaitForSemaphores(
+			std::initializer_list<sync::TimelineValue> p_values,
 			bool p_waitAll = true,
 			std::optional<uint64_t> p_timeout = std::nullopt
 		);
 
+		/**
+		* Sets how WaitForFences() and WaitForSemaphores() wait (e.g. spin for a while before blocking)
+		*/
+		void SetWaitStrategy(const sync::WaitStrategy& p_strategy);
+
+		/**
+		* Returns the current wait strategy
+		*/
+		const sync::WaitStrategy& GetWaitStrategy() const;
+
+		/**
+		* Returns the distribution of the wait times measured by WaitForFences() and WaitForSemaphores()
+		*/
+		sync::WaitHistogram& GetWaitHistogram();
+
 		/**
 		* Wait idle
 		*/
 		void WaitIdle();
 
+	private:
+		void LoadDispatch();
+
 	private:
 		bool m_suitable = false;
 		std::vector<utils::RequestedExtension> m_requestedExtensions;
@@ -147,9 +310,26 @@ namespace val
 		VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
 		VkPhysicalDeviceProperties m_physicalDeviceProperties;
 		VkPhysicalDeviceFeatures m_physicalDeviceFeatures;
+		VkPhysicalDeviceVulkan12Features m_physicalDeviceVulkan12Features;
+		VkPhysicalDeviceVulkan13Features m_physicalDeviceVulkan13Features;
+		VkPhysicalDeviceConditionalRenderingFeaturesEXT m_physicalDeviceConditionalRenderingFeatures;
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT m_physicalDeviceGraphicsPipelineLibraryFeatures;
+		VkPhysicalDeviceExtendedDynamicState3FeaturesEXT m_physicalDeviceExtendedDynamicState3Features;
+		VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT m_physicalDeviceSwapchainMaintenance1Features;
 		VkDevice m_logicalDevice = VK_NULL_HANDLE;
-		std::unique_ptr<Queue> m_graphicsQueue;
-		std::unique_ptr<Queue> m_presentQueue;
+		DeviceDispatch m_dispatch;
+		std::unique_ptr<GpuReactor> m_reactor;
+		std::vector<std::unique_ptr<Queue>> m_queues; // One per distinct VkQueue
+		Queue* m_graphicsQueue = nullptr;
+		Queue* m_presentQueue = nullptr;
+		Queue* m_computeQueue = nullptr;
+		Queue* m_transferQueue = nullptr;
+		std::unique_ptr<sync::FencePool> m_fencePool;
+		std::unique_ptr<sync::SemaphorePool> m_semaphorePool;
+		std::unique_ptr<DeletionQueue> m_deletionQueue;
+		std::unique_ptr<PipelineCache> m_pipelineCache;
+		sync::WaitStrategy m_waitStrategy;
+		sync::WaitHistogram m_waitHistogram;
 		QueueFamilyIndices m_queueFamilyIndices;
 		VkSurfaceKHR m_surface = VK_NULL_HANDLE;
 		utils::SwapChainSupportDetails m_swapChainSupportDetails;
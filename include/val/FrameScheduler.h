@@ -0,0 +1,144 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <val/sync/Fence.h>
+#include <val/sync/Semaphore.h>
+#include <val/sync/TimelineSemaphore.h>
+
+namespace val
+{
+	class Device;
+	class SwapChain;
+	class Image;
+
+	struct FrameSchedulerDesc
+	{
+		uint32_t framesInFlight = 2; // 2 = double buffering, 3 = triple buffering, etc.
+	};
+
+	struct FrameContext
+	{
+		uint32_t frameIndex; // Frame slot, in [0, framesInFlight), used to index per-frame resources
+		uint64_t frameNumber;
+		uint32_t swapImageIndex;
+		Image& swapChainImage;
+		VkImageView swapChainImageView;
+		sync::Semaphore& imageAvailableSemaphore; // To be waited by the frame submission (color attachment output stage)
+		sync::Semaphore& renderFinishedSemaphore; // To be signaled by the frame submission, waited by the presentation
+		sync::TimelineValue completionValue; // To be signaled by the frame submission
+	};
+
+	struct FrameWaitTimes
+	{
+		double frameSlotMs = 0.0; // CPU time spent waiting for the GPU to release the frame slot
+		double acquireMs = 0.0; // CPU time spent acquiring the next swap chain image
+	};
+
+	/**
+	* Paces frames in flight: waits for frame slots to be released by the GPU, acquires swap chain images and presents them.
+	* Frames are tracked using a single timeline semaphore: frame N signals the value N + 1 once its rendering completes.
+	* Acquire semaphores are owned per frame slot, present semaphores per swap chain image, so a semaphore is never
+	* signaled again while the presentation engine may still wait for it.
+	* Presentation isn't tracked by the frame timeline, so retired swap chains (and their present semaphores) are only released
+	* once their presentations are complete: using present fences if VK_EXT_swapchain_maintenance1 is supported, or by waiting
+	* for the present queue to be idle otherwise.
+	* @note frames must be submitted between BeginFrame() and EndFrame(), using the semaphores and timeline value of the frame context
+	*/
+	class FrameScheduler
+	{
+	public:
+		/**
+		* Creates a frame scheduler for the given swap chain
+		*/
+		FrameScheduler(Device& p_device, SwapChain& p_swapChain, const FrameSchedulerDesc& p_desc = {});
+
+		/**
+		* Destroys the frame scheduler, waiting for submitted frames to complete
+		*/
+		virtual ~FrameScheduler();
+
+		/**
+		* Waits for the frame slot to be released by the GPU, flushes the device deletion queue, and acquires the next swap chain image.
+		* The returned context is valid until EndFrame() is called.
+		* @note throws an OutOfDateSwapChain exception if the swap chain must be recreated (the frame doesn't begin)
+		*/
+		const FrameContext& BeginFrame();
+
+		/**
+		* Presents the swap chain image of the current frame, and moves to the next frame
+		* @note the frame must have been submitted, signaling its completion value
+		* @note throws an OutOfDateSwapChain exception if the swap chain must be recreated (the frame still ends)
+		*/
+		void EndFrame();
+
+		/**
+		* Replaces the swap chain (e.g. after a resize), and creates present semaphores for its images.
+		* Present semaphores of the previous swap chain are recycled once its presentations are complete.
+		* @note if given, the previous swap chain is destroyed along with its present semaphores
+		*/
+		void SetSwapChain(SwapChain& p_swapChain, std::unique_ptr<SwapChain> p_previousSwapChain = nullptr);
+
+		/**
+		* Returns the number of frames that can be in flight at the same time
+		*/
+		uint32_t GetFramesInFlight() const;
+
+		/**
+		* Returns the number of frames ended so far
+		*/
+		uint64_t GetFrameNumber() const;
+
+		/**
+		* Returns the timeline semaphore tracking frames completion
+		*/
+		sync::TimelineSemaphore& GetTimeline();
+
+		/**
+		* Returns the CPU wait times measured by the last BeginFrame() call
+		*/
+		const FrameWaitTimes& GetLastWaitTimes() const;
+
+		/**
+		* Returns the CPU wait times, smoothed over the last frames (exponential moving average).
+		* Long frame slot waits mean the CPU is ahead of the GPU (more frames in flight only add latency),
+		* while short ones mean the GPU may starve (more frames in flight may improve throughput).
+		*/
+		const FrameWaitTimes& GetAverageWaitTimes() const;
+
+	private:
+		struct RetiredSwapChain
+		{
+			std::unique_ptr<SwapChain> swapChain;
+			std::vector<sync::Semaphore*> presentSemaphores;
+			std::vector<sync::Fence*> presentFences; // Empty if present fences aren't supported
+		};
+
+		void RetireSwapChain(std::unique_ptr<SwapChain> p_swapChain);
+		void RecyclePresentFences();
+		void ReleaseRetiredSwapChains(bool p_wait);
+
+	private:
+		Device& m_device;
+		SwapChain* m_swapChain;
+		uint32_t m_framesInFlight;
+		sync::TimelineSemaphore m_timeline;
+		uint64_t m_frameNumber = 0;
+		std::vector<sync::Semaphore*> m_imageAvailableSemaphores;
+		std::vector<sync::Semaphore*> m_renderFinishedSemaphores;
+		std::vector<sync::Fence*> m_presentFences; // Present fences of the current swap chain, not signaled yet
+		std::vector<RetiredSwapChain> m_retiredSwapChains;
+		bool m_usePresentFences;
+		std::optional<FrameContext> m_currentFrame;
+		FrameWaitTimes m_lastWaitTimes;
+		FrameWaitTimes m_averageWaitTimes;
+	};
+}
@@ -0,0 +1,94 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <optional>
+#include <val/GpuReactor.h>
+#include <val/sync/TimelineSemaphore.h>
+
+namespace val
+{
+	/**
+	* Completion of GPU work (a timeline value), which can be polled, waited for, or awaited from a coroutine:
+	*	co_await service.Submit(std::move(batch)).get(); // Resumed on the reactor thread once the submission is complete
+	* @note coroutines are resumed on the reactor thread, so their next submissions race with other threads using the queue:
+	* coroutines must submit through a SubmissionService, never through the queue directly
+	*/
+	class GpuFuture
+	{
+	public:
+		/**
+		* Creates a future completed once the given timeline value is reached
+		*/
+		GpuFuture(const sync::TimelineValue& p_value, GpuReactor& p_reactor);
+
+		/**
+		* Returns true if the GPU work is complete
+		*/
+		bool IsReady() const;
+
+		/**
+		* Blocks until the GPU work is complete.
+		* Returns false if the timeout expired before.
+		*/
+		bool Wait(std::optional<uint64_t> p_timeout = std::nullopt) const;
+
+		/**
+		* Returns the timeline value reached once the GPU work is complete (e.g. to make another submission wait for it)
+		*/
+		const sync::TimelineValue& GetTimelineValue() const;
+
+		// Awaitable interface (co_await)
+		bool await_ready() const;
+		bool await_suspend(std::coroutine_handle<> p_coroutine) const;
+		void await_resume() const; // Rethrows the reactor error if the GPU work isn't complete
+
+	private:
+		sync::TimelineValue m_value;
+		GpuReactor& m_reactor;
+	};
+
+	/**
+	* Minimal coroutine type, to write GPU work (uploads, readbacks, compute...) as linear async code.
+	* The coroutine starts immediately, and owns itself (it doesn't need to be kept alive).
+	*/
+	class GpuTask
+	{
+	public:
+		struct promise_type
+		{
+			std::promise<void> promise;
+
+			GpuTask get_return_object() { return GpuTask(promise.get_future()); }
+			std::suspend_never initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() { promise.set_value(); }
+			void unhandled_exception() { promise.set_exception(std::current_exception()); }
+		};
+
+		/**
+		* Returns true if the coroutine has completed
+		*/
+		bool IsDone() const;
+
+		/**
+		* Blocks until the coroutine completes, and rethrows its exception (if any)
+		* @note coroutines awaiting GPU work must submit through a SubmissionService (see GpuFuture)
+		* @note must not be called from the reactor thread, if the coroutine awaits a GpuFuture
+		*/
+		void Wait();
+
+	private:
+		GpuTask(std::future<void> p_future);
+
+	private:
+		std::future<void> m_future;
+	};
+}
@@ -0,0 +1,130 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <val/QueryPool.h>
+
+namespace val
+{
+	class Device;
+	class CommandBuffer;
+
+	struct GpuScopeTiming
+	{
+		std::string name;
+		uint32_t depth;
+		std::optional<uint32_t> parent; // Index of the parent scope, in the same frame timings
+		double startMs; // Relative to the first collected timestamp
+		double durationMs;
+	};
+
+	struct GpuFrameTimings
+	{
+		uint64_t frameIndex;
+		std::vector<GpuScopeTiming> scopes; // Recording order, parents always come before their children
+	};
+
+	/**
+	* Measures the time spent by the GPU within named scopes, using timestamp queries.
+	* Each frame in flight has its own query pool, so results are read back without stalling
+	* once the frame slot is reused (i.e. once the frame's fence has been waited).
+	* @note scopes can be recorded concurrently (e.g. from RenderGraph pass callbacks), as long as each command buffer
+	* is recorded by a single thread. Scopes nest within their command buffer only.
+	*/
+	class GpuProfiler
+	{
+	public:
+		/**
+		* Creates a GPU profiler
+		* @note p_historySize is the number of collected frames kept for GetHistory() and ExportChromeTrace()
+		*/
+		GpuProfiler(
+			Device& p_device,
+			uint32_t p_framesInFlight,
+			uint32_t p_maxScopesPerFrame = 256,
+			uint32_t p_historySize = 120
+		);
+
+		/**
+		* Destroys the GPU profiler
+		*/
+		virtual ~GpuProfiler() = default;
+
+		/**
+		* Starts a new frame: collects the results of the frame previously recorded in the same slot, and resets its queries
+		* @note the previous frame using this slot must be complete (e.g. by waiting for its fence)
+		*/
+		void BeginFrame();
+
+		/**
+		* Opens a named scope. Scopes can be nested.
+		* @note thread-safe
+		*/
+		void BeginScope(CommandBuffer& p_commandBuffer, std::string_view p_name);
+
+		/**
+		* Closes the last scope opened on the given command buffer
+		* @note thread-safe
+		*/
+		void EndScope(CommandBuffer& p_commandBuffer);
+
+		/**
+		* Returns the timings of the most recently collected frame, if any
+		*/
+		const GpuFrameTimings* GetLastFrameTimings() const;
+
+		/**
+		* Returns the timings of the last collected frames, from the oldest to the most recent
+		*/
+		const std::deque<GpuFrameTimings>& GetHistory() const;
+
+		/**
+		* Returns the collected frames as a Chrome trace (JSON), which can be loaded in chrome://tracing or Perfetto
+		*/
+		std::string ExportChromeTrace() const;
+
+	private:
+		struct PendingScope
+		{
+			std::string name;
+			uint32_t depth;
+			std::optional<uint32_t> parent;
+		};
+
+		struct FrameSlot
+		{
+			std::unique_ptr<QueryPool> queryPool;
+			std::vector<PendingScope> scopes;
+			uint64_t frameIndex = 0;
+		};
+
+		void CollectResults(FrameSlot& p_slot);
+
+	private:
+		static constexpr uint32_t k_droppedScope = UINT32_MAX;
+
+		double m_timestampPeriod;
+		uint32_t m_maxScopesPerFrame;
+		uint32_t m_historySize;
+		uint64_t m_frameCount = 0;
+		std::optional<uint64_t> m_epoch;
+		std::vector<FrameSlot> m_slots;
+		FrameSlot* m_currentSlot = nullptr;
+		std::mutex m_scopesMutex;
+		std::unordered_map<VkCommandBuffer, std::vector<uint32_t>> m_openScopes; // Per command buffer, guarded by m_scopesMutex
+		std::deque<GpuFrameTimings> m_history;
+	};
+}
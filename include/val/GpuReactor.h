@@ -0,0 +1,74 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <val/sync/TimelineSemaphore.h>
+
+namespace val
+{
+	/**
+	* Resumes coroutines awaiting GPU work (see GpuFuture), once the timeline values they wait for are reached.
+	* A reactor thread blocks on every pending timeline value at once (vkWaitSemaphores, waiting for any of them),
+	* so no thread is blocked per pending operation, and nothing is polled.
+	* @note coroutines are resumed on the reactor thread
+	* @note if waiting fails, the reactor stops, and every awaiting coroutine is resumed to observe the error (see GetError())
+	*/
+	class GpuReactor
+	{
+	public:
+		/**
+		* Creates a reactor, and starts its thread
+		*/
+		GpuReactor(VkDevice p_device);
+
+		/**
+		* Stops the reactor thread
+		* @note coroutines still awaiting are never resumed
+		*/
+		virtual ~GpuReactor();
+
+		/**
+		* Resumes the given coroutine once the timeline value is reached.
+		* Returns false if the reactor has failed, in which case the coroutine isn't resumed (it must not be suspended).
+		* @note thread-safe
+		*/
+		bool Await(const sync::TimelineValue& p_value, std::coroutine_handle<> p_coroutine);
+
+		/**
+		* Returns the error that stopped the reactor, or null if it is still running
+		* @note thread-safe
+		*/
+		std::exception_ptr GetError() const;
+
+	private:
+		struct PendingAwait
+		{
+			sync::TimelineValue value;
+			std::coroutine_handle<> coroutine;
+		};
+
+		void Wake();
+		void Run();
+		void Fail(std::exception_ptr p_error, std::vector<std::coroutine_handle<>>& p_readyCoroutines);
+
+	private:
+		VkDevice m_device = VK_NULL_HANDLE;
+		mutable std::mutex m_mutex;
+		std::vector<PendingAwait> m_pendingAwaits;
+		sync::TimelineSemaphore m_wakeUpTimeline; // Signaled to interrupt the reactor wait when awaits are added
+		uint64_t m_wakeUpValue = 0;
+		bool m_stop = false;
+		std::exception_ptr m_error;
+		std::jthread m_thread;
+	};
+}
@@ -7,6 +7,13 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
 #include <val/ShaderProgram.h>
 #include <val/SwapChain.h>
 #include <val/RenderPass.h>
@@ -14,22 +21,151 @@
 
 namespace val
 {
+	class Device;
+
+	/**
+	* Canonical identity of a graphics pipeline (or of a part of it): descriptions with equal keys produce identical
+	* pipelines. Unlike hashes, keys can't collide, so they are used to deduplicate pipelines (see PipelineLibrary).
+	*/
+	struct GraphicsPipelineKey
+	{
+		std::vector<std::shared_ptr<const ShaderStageKey>> stages; // Shared with the shader program (see ShaderProgram::GetKeys())
+		std::vector<std::byte> state; // Everything else affecting the compiled pipeline
+
+		/**
+		* Returns a hash of the key (see GraphicsPipelineDesc::GetHash())
+		*/
+		uint64_t GetHash() const;
+
+		/**
+		* Returns true if both keys describe the same pipeline
+		*/
+		bool operator==(const GraphicsPipelineKey& p_other) const;
+	};
+
 	struct GraphicsPipelineDesc
 	{
 		ShaderProgram& program;
-		RenderPass& renderPass;
+		std::optional<std::reference_wrapper<RenderPass>> renderPass = std::nullopt; // If not set, the pipeline is used with dynamic rendering
 		std::span<const VkVertexInputAttributeDescription> vertexInputAttributeDesc;
 		std::span<const VkVertexInputBindingDescription> vertexInputBindingDesc;
 		std::span<const std::reference_wrapper<DescriptorSetLayout>> descriptorSetLayouts;
+		std::span<const VkPushConstantRange> pushConstantRanges;
+		std::span<const VkFormat> colorAttachmentFormats; // Dynamic rendering only
+		VkFormat depthAttachmentFormat = VK_FORMAT_UNDEFINED; // Dynamic rendering only
+		VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+		VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+		VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		VkSampleCountFlagBits rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		bool depthTestEnable = false;
+		bool depthWriteEnable = false;
+		VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+		VkPipelineColorBlendAttachmentState colorBlendAttachment{ // Applied to every color attachment
+			.blendEnable = VK_FALSE,
+			.srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+			.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
+			.colorBlendOp = VK_BLEND_OP_ADD,
+			.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+			.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+			.alphaBlendOp = VK_BLEND_OP_ADD,
+			.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+		};
+		std::span<const VkDynamicState> dynamicStates; // Viewport and scissor are always dynamic. Dynamic state overrides the baked values above.
+
+		/**
+		* Returns true if the given state is set dynamically (see CommandBuffer setters), instead of being baked into the pipeline
+		* @note extended dynamic state 3 states (VK_DYNAMIC_STATE_*_EXT) require the matching device feature
+		*/
+		bool IsDynamic(VkDynamicState p_state) const;
+
+		/**
+		* Returns a hash of everything that affects the compiled pipeline: shader content, vertex input, layouts,
+		* render pass compatibility (or attachment formats) and fixed-function state.
+		* Identical descriptions always produce the same hash, even if they reference different (but identical) shader modules.
+		* @note baked values of dynamic states are ignored, so descriptions only differing by dynamic state share a pipeline
+		*/
+		uint64_t GetHash() const;
+
+		/**
+		* Returns the canonical key of the description, covering the same state as its hash
+		*/
+		GraphicsPipelineKey GetKey() const;
+	};
+
+	/**
+	* Independently compiled subsets of a graphics pipeline (VK_EXT_graphics_pipeline_library)
+	*/
+	enum class EGraphicsPipelinePart : uint8_t
+	{
+		VertexInput, // Vertex input and input assembly
+		PreRasterization, // Vertex (and geometry/tessellation) shaders, viewport and rasterization
+		FragmentShader, // Fragment shader, depth/stencil and sample shading
+		FragmentOutput // Color blending, multisampling and attachment formats
+	};
+
+	/**
+	* A graphics pipeline library, compiling only one part of a graphics pipeline description.
+	* Parts are linked into a GraphicsPipeline, so permutations sharing most parts (e.g. only differing in
+	* vertex layout or blend state) only compile the parts that differ.
+	* @note requires graphics pipeline libraries to be supported (see Device::IsGraphicsPipelineLibrarySupported())
+	*/
+	class GraphicsPipelinePart
+	{
+	public:
+		/**
+		* Compiles the given part of a graphics pipeline description
+		*/
+		GraphicsPipelinePart(Device& p_device, EGraphicsPipelinePart p_part, const GraphicsPipelineDesc& p_desc);
+
+		/**
+		* Destroys the graphics pipeline part
+		*/
+		virtual ~GraphicsPipelinePart();
+
+		/**
+		* Returns the part of the pipeline this library contains
+		*/
+		EGraphicsPipelinePart GetPart() const;
+
+		/**
+		* Returns the VkPipeline handle of the library
+		*/
+		VkPipeline GetHandle() const;
+
+		/**
+		* Returns a hash of the state of the description affecting the given part only
+		*/
+		static uint64_t GetHash(EGraphicsPipelinePart p_part, const GraphicsPipelineDesc& p_desc);
+
+		/**
+		* Returns the canonical key of the state of the description affecting the given part only
+		*/
+		static GraphicsPipelineKey GetKey(EGraphicsPipelinePart p_part, const GraphicsPipelineDesc& p_desc);
+
+	private:
+		VkDevice m_device = VK_NULL_HANDLE;
+		EGraphicsPipelinePart m_part;
+		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_handle = VK_NULL_HANDLE;
 	};
 
 	class GraphicsPipeline
 	{
 	public:
+		static constexpr size_t k_partCount = 4;
+
+		/**
+		* Creates a graphics pipeline, using the pipeline cache of the given device
+		*/
+		GraphicsPipeline(Device& p_device, const GraphicsPipelineDesc& p_desc);
+
 		/**
-		* Creates a graphics pipeline
+		* Creates a graphics pipeline by linking the given parts (one of each EGraphicsPipelinePart) compiled from the same
+		* description (fast link, without link-time optimizations, so the resulting pipeline may be slightly slower)
+		* @note parts must outlive the pipeline, since they can be linked again by Optimize()
 		*/
-		GraphicsPipeline(VkDevice p_device, const GraphicsPipelineDesc& p_desc);
+		GraphicsPipeline(Device& p_device, const GraphicsPipelineDesc& p_desc, std::span<const std::reference_wrapper<const GraphicsPipelinePart>, k_partCount> p_parts);
 
 		/**
 		* Destroys the graphics pipeline
@@ -37,7 +173,25 @@ namespace val
 		virtual ~GraphicsPipeline();
 
 		/**
-		* Returns a VkPipeline handle
+		* Links the parts of this pipeline again, with link-time optimizations. Once done, GetHandle() returns the
+		* optimized pipeline, while the fast-linked pipeline is kept alive (it may still be used by recorded command buffers).
+		* @note does nothing if the pipeline isn't linked from parts, or is already optimized
+		* @note can be called from any thread (e.g. in the background, right after a fast link)
+		*/
+		void Optimize();
+
+		/**
+		* Returns true if the pipeline has been linked from parts (see GraphicsPipelinePart)
+		*/
+		bool IsLinked() const;
+
+		/**
+		* Returns true if the pipeline is fully optimized (compiled as a whole, or linked again by Optimize())
+		*/
+		bool IsOptimized() const;
+
+		/**
+		* Returns a VkPipeline handle (the optimized pipeline, if available)
 		*/
 		VkPipeline GetHandle() const;
 
@@ -46,9 +200,16 @@ namespace val
 		*/
 		VkPipelineLayout GetLayout() const;
 
+	private:
+		VkPipeline Link(VkPipelineCreateFlags p_flags) const;
+
 	private:
 		VkDevice m_device = VK_NULL_HANDLE;
+		VkPipelineCache m_pipelineCache = VK_NULL_HANDLE;
 		VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
 		VkPipeline m_graphicsPipeline = VK_NULL_HANDLE;
+		std::atomic<VkPipeline> m_optimizedPipeline = VK_NULL_HANDLE;
+		std::vector<VkPipeline> m_libraries;
+		std::mutex m_optimizeMutex;
 	};
 }
@@ -0,0 +1,97 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <val/sync/ResourceState.h>
+
+namespace val
+{
+	class Device;
+
+	struct ImageDesc
+	{
+		VkExtent3D extent;
+		VkFormat format;
+		VkImageUsageFlags usage;
+		VkImageAspectFlags aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		uint32_t mipLevels = 1;
+		uint32_t arrayLayers = 1;
+	};
+
+	class Image
+	{
+	public:
+		/**
+		* Creates a 2D image
+		*/
+		Image(Device& p_device, const ImageDesc& p_desc);
+
+		/**
+		* Wraps an existing image (e.g. a swap chain image) without taking ownership of it
+		*/
+		Image(Device& p_device, VkImage p_handle, const ImageDesc& p_desc);
+
+		/**
+		* Destroys the image (if owned)
+		*/
+		virtual ~Image();
+
+		/**
+		* Returns true if the image is allocated
+		*/
+		bool IsAllocated() const;
+
+		/**
+		* Allocate memory for the image
+		*/
+		void Allocate(VkMemoryPropertyFlags p_properties);
+
+		/**
+		* Deallocates memory for the image
+		*/
+		void Deallocate();
+
+		/**
+		* Returns the image desc
+		*/
+		const ImageDesc& GetDesc() const;
+
+		/**
+		* Returns a subresource range covering the whole image
+		*/
+		VkImageSubresourceRange GetSubresourceRange() const;
+
+		/**
+		* Returns the underlying VkImage handle
+		*/
+		VkImage GetHandle() const;
+
+		/**
+		* Returns the last known GPU state of the image (stage, access and layout)
+		* @note the state is tracked for the whole image, not per subresource
+		*/
+		const sync::ResourceState& GetState() const;
+
+		/**
+		* Overrides the last known GPU state of the image.
+		* @note CommandBuffer updates this state automatically when recording commands using the image
+		*/
+		void SetState(const sync::ResourceState& p_state);
+
+	private:
+		friend class CommandBuffer;
+
+	private:
+		Device& m_device;
+		ImageDesc m_desc;
+		bool m_owned = true;
+		VkImage m_handle = VK_NULL_HANDLE;
+		VkDeviceMemory m_memory = VK_NULL_HANDLE;
+		sync::ResourceState m_state;
+	};
+}
@@ -0,0 +1,68 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+
+namespace val
+{
+	class Device;
+
+	/**
+	* Pipeline cache shared by every pipeline creation, persisted to disk so pipelines compiled by a previous run
+	* don't need to be compiled again.
+	* The file is only loaded if its header matches the current device (vendor, device and pipeline cache UUID),
+	* since drivers may reject (or even crash on) foreign data.
+	* @note thread-safe (pipeline caches are internally synchronized, and saves are serialized)
+	*/
+	class PipelineCache
+	{
+	public:
+		/**
+		* Creates a pipeline cache, initialized with the content of the given file (if it exists and is valid)
+		*/
+		PipelineCache(Device& p_device, std::optional<std::filesystem::path> p_path = std::nullopt);
+
+		/**
+		* Saves the pipeline cache (if a path is set), then destroys it
+		*/
+		virtual ~PipelineCache();
+
+		/**
+		* Saves the pipeline cache to its file, if it changed since the last save.
+		* The file is written next to the destination, then renamed, so a crash never leaves a partially written cache.
+		* Returns false if the cache couldn't be saved (or if no path is set).
+		* @note can be called periodically (e.g. every few minutes), to keep pipelines compiled by a session that crashes
+		*/
+		bool Save();
+
+		/**
+		* Returns true if the cache was initialized from a valid file
+		*/
+		bool IsLoadedFromDisk() const;
+
+		/**
+		* Returns the underlying VkPipelineCache handle
+		*/
+		VkPipelineCache GetHandle() const;
+
+	private:
+		bool IsCompatible(std::span<const std::byte> p_data) const;
+
+	private:
+		Device& m_device;
+		std::optional<std::filesystem::path> m_path;
+		VkPipelineCache m_handle = VK_NULL_HANDLE;
+		bool m_loadedFromDisk = false;
+		std::mutex m_saveMutex;
+		size_t m_savedSize = 0; // Guarded by m_saveMutex
+	};
+}
@@ -0,0 +1,189 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <val/GraphicsPipeline.h>
+#include <val/utils/ThreadPool.h>
+
+namespace val
+{
+	class Device;
+
+	enum class EPipelineState : uint8_t
+	{
+		Pending,
+		Ready,
+		Failed
+	};
+
+	struct PipelineLibraryDesc
+	{
+		uint32_t compileThreadCount = 0; // See utils::ThreadPool
+		bool useGraphicsPipelineLibraries = true; // Ignored if not supported by the device
+		bool optimizeInBackground = true; // Linked pipelines are optimized on a compilation thread once ready
+	};
+
+	/**
+	* Deduplicates graphics pipelines: requesting a pipeline for a description identical to a previous one
+	* (see GraphicsPipelineDesc::GetKey()) returns the existing pipeline instead of compiling it again.
+	* Hashes only select the slots to probe, entries are matched by comparing their keys.
+	* Pipelines can be compiled synchronously (GetOrCreate), or on a pool of compilation threads (RequestAsync).
+	* Lookups are lock-free (open-addressing table of atomics, replaced on growth), only insertions take a lock.
+	* If graphics pipeline libraries are supported, pipelines are linked from parts (see GraphicsPipelinePart) which are
+	* deduplicated as well, so a new permutation only compiles the parts that differ from existing pipelines.
+	* @note pipelines are owned by the library, and live until it is destroyed
+	* @note thread-safe
+	*/
+	class PipelineLibrary
+	{
+	private:
+		struct Entry
+		{
+			GraphicsPipelineKey key; // Set before the entry is published, never modified
+			std::atomic<EPipelineState> state = EPipelineState::Pending;
+			std::unique_ptr<GraphicsPipeline> pipeline; // Set before the state becomes Ready
+		};
+
+	public:
+		/**
+		* Reference to a pipeline of the library, which may still be compiling
+		* @note cheap to copy, valid as long as the library exists
+		*/
+		class Handle
+		{
+		public:
+			/**
+			* Creates an invalid handle
+			*/
+			Handle() = default;
+
+			/**
+			* Returns true if the handle refers to a pipeline of the library
+			*/
+			bool IsValid() const;
+
+			/**
+			* Returns true if the pipeline is compiled and can be used (lock-free)
+			*/
+			bool IsReady() const;
+
+			/**
+			* Returns true if the pipeline compilation failed
+			*/
+			bool HasFailed() const;
+
+			/**
+			* Blocks until the pipeline compilation is done (successfully or not)
+			*/
+			void Wait() const;
+
+			/**
+			* Returns the pipeline if it is ready, nullptr otherwise (e.g. to skip a draw or use a fallback pipeline)
+			*/
+			GraphicsPipeline* TryGet() const;
+
+			/**
+			* Returns the pipeline
+			* @note will assert if the pipeline isn't ready
+			*/
+			GraphicsPipeline& Get() const;
+
+		private:
+			Handle(const Entry& p_entry);
+
+			friend class PipelineLibrary;
+
+		private:
+			const Entry* m_entry = nullptr;
+		};
+
+		/**
+		* Creates an empty pipeline library
+		*/
+		PipelineLibrary(Device& p_device, const PipelineLibraryDesc& p_desc = {});
+
+		/**
+		* Destroys the pipeline library, and every pipeline it contains
+		* @note waits for pending compilations to complete
+		* @note pipelines must not be in use by the GPU anymore
+		*/
+		virtual ~PipelineLibrary();
+
+		/**
+		* Returns the pipeline matching the given description, compiling it on the calling thread if it doesn't exist yet.
+		* If the pipeline is being compiled asynchronously, waits for it.
+		* @note the compilation happens outside of the lock, so concurrent requests for different pipelines don't serialize
+		*/
+		GraphicsPipeline& GetOrCreate(const GraphicsPipelineDesc& p_desc);
+
+		/**
+		* Returns a handle to the pipeline matching the given description, scheduling its compilation on a compilation
+		* thread if it doesn't exist yet. The handle reports when the pipeline is ready.
+		* @note the description is copied, but the (immutable) shader program and referenced objects (layouts, render pass)
+		* must outlive the compilation
+		*/
+		Handle RequestAsync(const GraphicsPipelineDesc& p_desc);
+
+		/**
+		* Returns a handle to the pipeline matching the given description (invalid if it doesn't exist, lock-free)
+		*/
+		Handle Find(const GraphicsPipelineDesc& p_desc) const;
+
+		/**
+		* Returns the number of pipelines in the library (including pipelines being compiled)
+		*/
+		size_t GetPipelineCount() const;
+
+	private:
+		struct Slot
+		{
+			std::atomic<uint64_t> hash = 0; // 0 marks an empty slot (see ToSlotHash())
+			std::atomic<Entry*> entry = nullptr;
+		};
+
+		struct KeyHash
+		{
+			size_t operator()(const GraphicsPipelineKey& p_key) const;
+		};
+
+		// Power-of-two sized, never shrinks, and entries are never removed
+		using Table = std::vector<Slot>;
+
+		struct PartEntry
+		{
+			std::once_flag compiled;
+			std::unique_ptr<GraphicsPipelinePart> part;
+		};
+
+		// Returns the entry for the given key, and true if it has just been created (the caller must compile it)
+		std::pair<Entry*, bool> Claim(GraphicsPipelineKey&& p_key);
+		void Compile(Entry& p_entry, const GraphicsPipelineDesc& p_desc);
+		const GraphicsPipelinePart& GetOrCreatePart(EGraphicsPipelinePart p_part, const GraphicsPipelineDesc& p_desc);
+
+		static uint64_t ToSlotHash(uint64_t p_hash);
+		static Entry* Lookup(const Table& p_table, uint64_t p_slotHash, const GraphicsPipelineKey& p_key);
+		static void Insert(Table& p_table, uint64_t p_slotHash, Entry* p_entry);
+
+	private:
+		Device& m_device;
+		const bool m_useGraphicsPipelineLibraries;
+		const bool m_optimizeInBackground;
+		std::atomic<Table*> m_table = nullptr;
+		mutable std::mutex m_writeMutex;
+		std::vector<std::unique_ptr<Table>> m_tables; // Replaced tables are kept alive, as readers may still be using them
+		std::vector<std::unique_ptr<Entry>> m_entries;
+		std::mutex m_partsMutex;
+		std::unordered_map<GraphicsPipelineKey, std::unique_ptr<PartEntry>, KeyHash> m_parts;
+		std::unique_ptr<utils::ThreadPool> m_compileThreads;
+	};
+}
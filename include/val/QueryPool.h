@@ -0,0 +1,108 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <optional>
+#include <span>
+
+namespace val
+{
+	class Device;
+
+	struct QueryPoolDesc
+	{
+		VkQueryType type;
+		uint32_t count;
+		VkQueryPipelineStatisticFlags pipelineStatistics = 0; // Only used by pipeline statistics queries
+	};
+
+	/**
+	* Decoded pipeline statistics query result. Counters that weren't requested are left to 0.
+	*/
+	struct PipelineStatistics
+	{
+		uint64_t inputAssemblyVertices = 0;
+		uint64_t inputAssemblyPrimitives = 0;
+		uint64_t vertexShaderInvocations = 0;
+		uint64_t clippingInvocations = 0;
+		uint64_t clippingPrimitives = 0;
+		uint64_t fragmentShaderInvocations = 0;
+		uint64_t computeShaderInvocations = 0;
+	};
+
+	class QueryPool
+	{
+	public:
+		/**
+		* Creates a query pool
+		* @note queries are reset on creation, so they can be used right away
+		*/
+		QueryPool(Device& p_device, const QueryPoolDesc& p_desc);
+
+		/**
+		* Destroys the query pool
+		*/
+		virtual ~QueryPool();
+
+		/**
+		* Resets a range of queries from the host
+		* @note queries must not be in use by the GPU
+		*/
+		void Reset(uint32_t p_firstQuery, uint32_t p_queryCount);
+
+		/**
+		* Resets every query from the host
+		* @note queries must not be in use by the GPU
+		*/
+		void Reset();
+
+		/**
+		* Retrieves 64-bit results of a range of queries, without waiting for them to be available.
+		* Returns false if some results aren't available yet.
+		* @note p_results must hold at least one value per query (more if extra flags such as availability are requested)
+		*/
+		bool GetResults(
+			uint32_t p_firstQuery,
+			uint32_t p_queryCount,
+			std::span<uint64_t> p_results,
+			VkQueryResultFlags p_flags = 0
+		) const;
+
+		/**
+		* Returns the decoded result of a pipeline statistics query, or std::nullopt if it isn't available yet
+		*/
+		std::optional<PipelineStatistics> GetPipelineStatistics(uint32_t p_query) const;
+
+		/**
+		* Returns the number of samples that passed the depth and stencil tests for an occlusion query,
+		* or std::nullopt if it isn't available yet
+		* @note without VK_QUERY_CONTROL_PRECISE_BIT, any non-zero value only means that some samples passed
+		*/
+		std::optional<uint64_t> GetOcclusionResult(uint32_t p_query) const;
+
+		/**
+		* Returns the number of values written per query (e.g. one per enabled counter for pipeline statistics)
+		*/
+		uint32_t GetValueCountPerQuery() const;
+
+		/**
+		* Returns the query pool description
+		*/
+		const QueryPoolDesc& GetDesc() const;
+
+		/**
+		* Returns the query pool handle
+		*/
+		VkQueryPool GetHandle() const;
+
+	private:
+		Device& m_device;
+		QueryPoolDesc m_desc;
+		VkQueryPool m_handle = VK_NULL_HANDLE;
+	};
+}
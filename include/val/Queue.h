@@ -11,12 +11,30 @@
 #include <vulkan/vulkan.h>
 #include <val/sync/Fence.h>
 #include <val/sync/Semaphore.h>
+#include <val/sync/TimelineSemaphore.h>
 #include <val/CommandBuffer.h>
+#include <val/SubmitBatch.h>
+#include <val/GpuFuture.h>
+#include <val/GpuReactor.h>
 
 namespace val
 {
 	class SwapChain;
+	class SubmissionService;
 
+	enum class EQueueType
+	{
+		Graphics,
+		Compute,
+		Transfer
+	};
+
+	/**
+	* Wraps a VkQueue, which requires external synchronization: a queue must not be used from several threads
+	* at the same time (use a SubmissionService to submit from worker threads).
+	* Once a SubmissionService is created for a queue, Submit(), Present() and WaitIdle() are forwarded to its submission thread,
+	* so components using the queue directly (RenderGraph, FrameScheduler, Uploader...) stay safe.
+	*/
 	class Queue
 	{
 	public:
@@ -26,33 +44,93 @@ namespace val
 		virtual ~Queue() = default;
 
 		/**
-		* Submit the queue
+		* Queues can't be copied, since they own the timeline tracking their submissions
+		*/
+		Queue(const Queue&) = delete;
+		Queue& operator=(const Queue&) = delete;
+
+		/**
+		* Submit the queue.
+		* Every submit returns a future, completed once the submitted work is complete (it can be ignored).
 		*/
-		void Submit(
+		GpuFuture Submit(
 			std::initializer_list<std::reference_wrapper<val::CommandBuffer>> p_commandBuffers,
 			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores = {},
 			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores = {},
 			std::optional<std::reference_wrapper<sync::Fence>> p_fence = std::nullopt
 		);
 
+		/**
+		* Submit the queue, with a list of command buffers built at runtime
+		*/
+		GpuFuture Submit(
+			std::span<const std::reference_wrapper<val::CommandBuffer>> p_commandBuffers,
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores = {},
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores = {},
+			std::optional<std::reference_wrapper<sync::Fence>> p_fence = std::nullopt
+		);
+
+		/**
+		* Submit the queue, waiting for and signaling timeline semaphore values in addition to binary semaphores
+		* @note binary semaphores are waited at the color attachment output stage, timeline semaphores at any stage
+		* (use a SubmitBatch to provide precise stage masks)
+		*/
+		GpuFuture Submit(
+			std::span<const std::reference_wrapper<val::CommandBuffer>> p_commandBuffers,
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
+			std::initializer_list<sync::TimelineValue> p_waitValues,
+			std::initializer_list<sync::TimelineValue> p_signalValues,
+			std::optional<std::reference_wrapper<sync::Fence>> p_fence = std::nullopt
+		);
+
+		/**
+		* Submit every submission of the batch, using a single vkQueueSubmit2 call.
+		* The fence (if any) is signaled once all of them are complete.
+		*/
+		GpuFuture Submit(
+			const SubmitBatch& p_batch,
+			std::optional<std::reference_wrapper<sync::Fence>> p_fence = std::nullopt
+		);
+
+		/**
+		* Presents a swap chain image once the given semaphores are signaled.
+		* If a fence is given, it is signaled once the presentation engine is done with the wait semaphores
+		* (and the swap chain image), which is the only way to know when present semaphores can be reused.
+		* @note present fences require VK_EXT_swapchain_maintenance1 (see Device::IsSwapchainMaintenance1Supported())
+		*/
 		void Present(
 			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
 			val::SwapChain& p_swapChain,
-			uint32_t p_swapChainIndice
+			uint32_t p_swapChainIndice,
+			std::optional<std::reference_wrapper<sync::Fence>> p_fence = std::nullopt
 		);
 
+		/**
+		* Waits for every operation submitted to the queue (including presentations) to complete
+		*/
+		void WaitIdle();
+
 		/**
 		* Returns the VkQueue handle
 		*/
 		VkQueue GetHandle() const;
 
 	private:
-		Queue(VkDevice p_device, VkQueue p_queue);
+		Queue(VkDevice p_device, VkQueue p_queue, GpuReactor& p_reactor);
+
+		// Returns true if calls must be forwarded to the submission service
+		bool IsForwarded() const;
 
 		friend class Device;
+		friend class SubmissionService;
 
 	private:
 		VkDevice m_device = VK_NULL_HANDLE;
 		VkQueue m_handle = VK_NULL_HANDLE;
+		GpuReactor& m_reactor;
+		sync::TimelineSemaphore m_timeline; // Signaled by each submission, with an incremented value
+		uint64_t m_lastSubmissionValue = 0;
+		SubmissionService* m_service = nullptr; // Set by the submission service owning the queue (if any)
 	};
 }
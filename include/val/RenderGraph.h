@@ -0,0 +1,290 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <val/Buffer.h>
+#include <val/Image.h>
+#include <val/Queue.h>
+#include <val/sync/BarrierBatch.h>
+#include <val/sync/TimelineSemaphore.h>
+#include <val/utils/ThreadPool.h>
+
+namespace val
+{
+	class Device;
+	class CommandPool;
+	class CommandBuffer;
+	class RenderGraph;
+
+	using RenderGraphResource = uint32_t;
+
+	/**
+	* Given to a pass setup callback, so the pass can declare the resources it reads and writes
+	*/
+	class RenderGraphPassBuilder
+	{
+	public:
+		/**
+		* Declares a transient buffer, created (or reused) by the graph, and only valid during the graph execution
+		*/
+		RenderGraphResource CreateBuffer(const BufferDesc& p_desc);
+
+		/**
+		* Declares a transient image, created (or reused) by the graph, and only valid during the graph execution
+		*/
+		RenderGraphResource CreateImage(const ImageDesc& p_desc);
+
+		/**
+		* Declares that the pass reads the given resource, in the given state
+		*/
+		void Read(RenderGraphResource p_resource, const sync::ResourceState& p_state);
+
+		/**
+		* Declares that the pass writes the given resource, in the given state
+		*/
+		void Write(RenderGraphResource p_resource, const sync::ResourceState& p_state);
+
+		/**
+		* Prevents the pass from being culled, even if none of its outputs are used.
+		* @note useful for passes writing to resources that aren't tracked by the graph (e.g. swap chain framebuffers)
+		*/
+		void SetSideEffect();
+
+	private:
+		RenderGraphPassBuilder(RenderGraph& p_graph, uint32_t p_passIndex);
+
+		friend class RenderGraph;
+
+	private:
+		RenderGraph& m_graph;
+		uint32_t m_passIndex;
+	};
+
+	/**
+	* Schedules a frame made of multiple passes. Each pass declares the resources it reads and writes,
+	* and the graph takes care of culling unused passes, ordering them, emitting barriers and layout
+	* transitions, reusing transient resources, and recording command buffers in parallel.
+	* Passes are submitted to the queue matching their type. Dependencies between passes of different queues are
+	* synchronized with timeline semaphores, and resources are transferred between queue families when needed.
+	* @note command buffers and transient resources are reused from one execution to the next,
+	* so the previous execution must be complete (e.g. by waiting for its fence) before calling Reset()
+	* @note imported resources must be owned by the graphics queue family, and are returned to it by the graph
+	*/
+	class RenderGraph
+	{
+	public:
+		using SetupCallback = std::function<void(RenderGraphPassBuilder&)>;
+		using ExecuteCallback = std::function<void(CommandBuffer&)>;
+
+		/**
+		* Creates a render graph
+		* @note if p_recordingThreadCount is 0, the number of hardware threads is used (including the calling thread)
+		*/
+		RenderGraph(Device& p_device, uint32_t p_recordingThreadCount = 0);
+
+		/**
+		* Destroys the render graph, and every transient resource it owns
+		*/
+		virtual ~RenderGraph();
+
+		/**
+		* Makes an externally owned buffer available to the graph passes
+		*/
+		RenderGraphResource ImportBuffer(Buffer& p_buffer);
+
+		/**
+		* Makes an externally owned image available to the graph passes
+		*/
+		RenderGraphResource ImportImage(Image& p_image);
+
+		/**
+		* Marks a resource as an output of the graph. Passes contributing to an output are never culled.
+		* If a final state is provided, the resource is transitioned to this state at the end of the graph.
+		*/
+		void MarkAsOutput(RenderGraphResource p_resource, std::optional<sync::ResourceState> p_finalState = std::nullopt);
+
+		/**
+		* Adds a pass to the graph. The setup callback is invoked immediately to declare the pass resources.
+		* @note execute callbacks may be invoked concurrently from different threads
+		* @note the command buffer given to the execute callback is allocated for the queue family of the pass
+		*/
+		void AddPass(
+			std::string_view p_name,
+			EQueueType p_queueType,
+			const SetupCallback& p_setup,
+			ExecuteCallback p_execute
+		);
+
+		/**
+		* Culls unused passes, orders the remaining ones, assigns transient resources and computes barriers
+		*/
+		void Compile();
+
+		/**
+		* Records every pass (in parallel) and submits them in order, to their respective queues.
+		* Returns a future completed once the graph execution is complete (on every queue).
+		* @note binary semaphores are waited by the graphics queue, and signaled (as well as the fence) once every queue is done
+		* @note Compile() must be called before each call to Execute()
+		*/
+		GpuFuture Execute(
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores = {},
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores = {},
+			std::optional<std::reference_wrapper<sync::Fence>> p_fence = std::nullopt
+		);
+
+		/**
+		* Records every pass (in parallel) and submits them in order, waiting for and signaling timeline semaphore values
+		* @note timeline values are waited by every queue used by the graph
+		* @note Compile() must be called before each call to Execute()
+		*/
+		GpuFuture Execute(
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
+			std::initializer_list<sync::TimelineValue> p_waitValues,
+			std::initializer_list<sync::TimelineValue> p_signalValues,
+			std::optional<std::reference_wrapper<sync::Fence>> p_fence = std::nullopt
+		);
+
+		/**
+		* Removes every pass and resource declaration, so the graph can be built again for the next frame.
+		* Transient resources and command buffers are kept for reuse.
+		*/
+		void Reset();
+
+		/**
+		* Returns the buffer associated with the given resource
+		* @note transient buffers are only available after Compile()
+		*/
+		Buffer& GetBuffer(RenderGraphResource p_resource) const;
+
+		/**
+		* Returns the image associated with the given resource
+		* @note transient images are only available after Compile()
+		*/
+		Image& GetImage(RenderGraphResource p_resource) const;
+
+		/**
+		* Returns the names of the passes that will be executed, in execution order
+		* @note Compile() must be called before calling GetExecutionOrder()
+		*/
+		std::vector<std::string_view> GetExecutionOrder() const;
+
+	private:
+		friend class RenderGraphPassBuilder;
+
+		struct ResourceAccess
+		{
+			RenderGraphResource resource;
+			sync::ResourceState state;
+			bool write;
+		};
+
+		struct PassNode
+		{
+			std::string name;
+			EQueueType queueType;
+			Queue* queue = nullptr;
+			uint32_t queueFamilyIndex = 0;
+			ExecuteCallback execute;
+			std::vector<ResourceAccess> accesses;
+			std::vector<uint32_t> dependencies; // Passes this pass must execute after
+			bool sideEffect = false;
+			uint32_t level = 0;
+		};
+
+		struct ResourceNode
+		{
+			Buffer* buffer = nullptr;
+			Image* image = nullptr;
+			std::optional<BufferDesc> transientBufferDesc;
+			std::optional<ImageDesc> transientImageDesc;
+			bool output = false;
+			std::optional<sync::ResourceState> finalState;
+			std::optional<uint32_t> firstLevel;
+			uint32_t lastLevel = 0;
+			std::optional<const Queue*> queue; // Queue of every pass using the resource, nullptr if used by several queues
+		};
+
+		template<class T, class Desc>
+		struct TransientResource
+		{
+			std::unique_ptr<T> resource;
+			Desc desc;
+			uint32_t availableFrom = 0;
+			uint32_t unusedCompilations = 0;
+			const Queue* queue = nullptr; // Queue of the passes using the resource, only reused by the same queue
+		};
+
+		struct RecordingPool
+		{
+			std::unique_ptr<CommandPool> commandPool;
+			std::vector<std::reference_wrapper<CommandBuffer>> commandBuffers;
+			size_t usedCommandBuffers = 0;
+		};
+
+		struct RecordingWorker
+		{
+			std::unordered_map<EQueueType, RecordingPool> pools; // Command buffers must be allocated for the queue family using them
+		};
+
+		struct QueueTimeline
+		{
+			std::unique_ptr<sync::TimelineSemaphore> semaphore;
+			uint64_t lastValue = 0;
+		};
+
+		RenderGraphResource AddResource(ResourceNode&& p_node);
+		void CullPasses(std::vector<bool>& p_alive) const;
+		void SortPasses(const std::vector<bool>& p_alive);
+		void AssignTransientResources();
+		void ComputeBarriers();
+		void RecordPass(uint32_t p_position, CommandBuffer& p_commandBuffer);
+		CommandBuffer& RecordBarriers(sync::BarrierBatch& p_barriers);
+		GpuFuture SubmitToQueues(
+			std::span<CommandBuffer* const> p_commandBuffers,
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
+			std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
+			std::initializer_list<sync::TimelineValue> p_waitValues,
+			std::initializer_list<sync::TimelineValue> p_signalValues,
+			std::optional<std::reference_wrapper<sync::Fence>> p_fence
+		);
+		CommandBuffer& AcquireCommandBuffer(RecordingWorker& p_worker, EQueueType p_queueType);
+		QueueTimeline& GetTimeline(const Queue& p_queue);
+		Queue& GetQueue(EQueueType p_queueType) const;
+
+	private:
+		Device& m_device;
+		uint32_t m_recordingThreadCount;
+		bool m_compiled = false;
+		std::vector<PassNode> m_passes;
+		std::vector<ResourceNode> m_resources;
+		std::vector<uint32_t> m_executionOrder;
+		std::vector<Queue*> m_queues; // Queues used by the compiled graph, the graphics queue first
+		std::vector<sync::BarrierBatch> m_barriers; // Recorded before each pass
+		std::vector<sync::BarrierBatch> m_releaseBarriers; // Recorded after each pass (queue family ownership releases)
+		std::vector<std::vector<uint32_t>> m_crossQueueWaits; // Positions of the passes of other queues each pass waits for
+		std::vector<bool> m_crossQueueSignals; // Whether a pass is waited for by another queue
+		sync::BarrierBatch m_prologueBarriers; // Releases of imported resources first used by another queue family
+		sync::BarrierBatch m_finalBarriers;
+		std::unordered_map<Buffer*, sync::ResourceState> m_simulatedBufferStates;
+		std::unordered_map<Image*, sync::ResourceState> m_simulatedImageStates;
+		std::vector<TransientResource<Buffer, BufferDesc>> m_transientBuffers;
+		std::vector<TransientResource<Image, ImageDesc>> m_transientImages;
+		std::vector<RecordingWorker> m_workers;
+		std::unique_ptr<utils::ThreadPool> m_recordingThreads;
+		std::unordered_map<const Queue*, QueueTimeline> m_timelines;
+	};
+}
@@ -32,8 +32,15 @@ namespace val
 		*/
 		VkRenderPass GetHandle() const;
 
+		/**
+		* Returns the format of the color attachment
+		* @note render passes sharing the same format are compatible, so pipelines can be shared between them
+		*/
+		VkFormat GetFormat() const;
+
 	private:
 		VkDevice m_device = VK_NULL_HANDLE;
 		VkRenderPass m_handle = VK_NULL_HANDLE;
+		VkFormat m_format = VK_FORMAT_UNDEFINED;
 	};
 }
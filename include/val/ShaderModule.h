@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <span>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 namespace val
@@ -29,8 +31,20 @@ namespace val
 		*/
 		VkShaderModule GetHandle() const;
 
+		/**
+		* Returns a hash of the shader byte code, identifying the shader content regardless of the module handle
+		*/
+		uint64_t GetHash() const;
+
+		/**
+		* Returns the shader byte code (kept to compare shader content exactly, see ShaderStage::GetKey())
+		*/
+		std::span<const std::byte> GetByteCode() const;
+
 	private:
 		VkDevice m_device = VK_NULL_HANDLE;
 		VkShaderModule m_handle = VK_NULL_HANDLE;
+		std::vector<std::byte> m_byteCode;
+		uint64_t m_hash = 0;
 	};
 }
@@ -6,9 +6,11 @@
 
 #pragma once
 
+#include <memory>
 #include <span>
 #include <vulkan/vulkan.h>
 #include <val/ShaderStage.h>
+#include <string>
 #include <vector>
 
 namespace val
@@ -18,20 +20,50 @@ namespace val
 	public:
 		/**
 		* Creates a shader program
+		* @note stages are copied (including their entry point and specialization), so the program is immutable:
+		* specializing a stage afterwards doesn't affect it, nor pipelines being compiled from it
 		*/
 		ShaderProgram(std::initializer_list<const std::reference_wrapper<ShaderStage>> p_stages);
 
+		/**
+		* The create infos point to the program storage, so programs can't be copied
+		*/
+		ShaderProgram(const ShaderProgram&) = delete;
+		ShaderProgram& operator=(const ShaderProgram&) = delete;
+
 		/**
 		* Destroys the shader program
 		*/
 		virtual ~ShaderProgram() = default;
 
 		/**
-		* Returns a contiguous array with create info for each shader stage
+		* Returns a contiguous array with create info for each shader stage (including their specialization)
 		*/
 		std::vector<VkPipelineShaderStageCreateInfo> GetAssembledStages();
 
+		/**
+		* Returns a hash of the program, combining the hash of each of its stages (in order)
+		*/
+		uint64_t GetHash() const;
+
+		/**
+		* Returns a hash combining only the stages matching the given flags (e.g. for graphics pipeline library parts)
+		*/
+		uint64_t GetHash(VkShaderStageFlags p_stages) const;
+
+		/**
+		* Returns the keys of the stages matching the given flags (in order), shared by every pipeline key built
+		* from this program, so comparing keys of the same program doesn't compare byte code
+		*/
+		std::vector<std::shared_ptr<const ShaderStageKey>> GetKeys(VkShaderStageFlags p_stages = VK_SHADER_STAGE_ALL) const;
+
 	private:
 		std::vector<VkPipelineShaderStageCreateInfo> m_assembledStages;
+		std::vector<std::string> m_entryPoints;
+		std::vector<std::vector<VkSpecializationMapEntry>> m_specializationMapEntries;
+		std::vector<std::vector<std::byte>> m_specializationData;
+		std::vector<VkSpecializationInfo> m_specializationInfos;
+		std::vector<std::shared_ptr<const ShaderStageKey>> m_stageKeys;
+		uint64_t m_hash = 0;
 	};
 }
@@ -8,28 +8,166 @@
 
 #include <val/ShaderModule.h>
 #include <vulkan/vulkan.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+* Declares a specialization map entry for a member of a struct of specialization constants, at compile time.
+* e.g. static constexpr auto GetSpecializationMap() { return std::to_array({ VAL_SPECIALIZATION_CONSTANT(Constants, sampleCount, 0) }); }
+*/
+#define VAL_SPECIALIZATION_CONSTANT(type, member, constantId) \
+	VkSpecializationMapEntry{ (constantId), static_cast<uint32_t>(offsetof(type, member)), sizeof(type::member) }
 
 namespace val
 {
+	/**
+	* Struct of specialization constants, providing its own map entries through a static constexpr GetSpecializationMap()
+	* (see VAL_SPECIALIZATION_CONSTANT)
+	* @note the map is returned by a function, since the struct is incomplete (no offsetof) in its static members
+	*/
+	template<class T>
+	concept SpecializationConstants = std::is_trivially_copyable_v<T> && requires {
+		{ T::GetSpecializationMap() };
+	};
+
+	/**
+	* Returns true if the size of a specialization constant matches a SPIR-V scalar (32 or 64 bits).
+	* Booleans in particular must be declared as VkBool32, since a C++ bool is a single byte.
+	*/
+	constexpr bool IsValidSpecializationConstantSize(size_t p_size)
+	{
+		return p_size == sizeof(uint32_t) || p_size == sizeof(uint64_t);
+	}
+
+	/**
+	* Canonical identity of a shader stage: stages with equal keys compile to the same shader, whatever their module handle
+	*/
+	struct ShaderStageKey
+	{
+		uint64_t hash = 0; // See ShaderStage::GetHash(), compared first
+		std::vector<std::byte> bytes; // Byte code, stage, entry point and specialization
+
+		bool operator==(const ShaderStageKey& p_other) const = default;
+	};
+
 	class ShaderStage
 	{
 	public:
 		/**
-		* Creates a shader stage
+		* Creates a shader stage, using the given entry point of the shader module
 		*/
-		ShaderStage(const ShaderModule& p_shaderModule, VkShaderStageFlagBits p_stage);
+		ShaderStage(const ShaderModule& p_shaderModule, VkShaderStageFlagBits p_stage, std::string p_entryPoint = "main");
+
+		/**
+		* The create info points to the stage storage (entry point, specialization data), so stages can't be copied
+		*/
+		ShaderStage(const ShaderStage&) = delete;
+		ShaderStage& operator=(const ShaderStage&) = delete;
 
 		/**
 		* Destroys the shader stage
 		*/
 		virtual ~ShaderStage() = default;
 
+		/**
+		* Sets the value of a specialization constant (layout(constant_id = id) in GLSL).
+		* The driver compiles the shader with this value, so branches and loops depending on it can be folded.
+		* @note booleans are converted to VkBool32, as expected by SPIR-V
+		* @note specializations must be set before creating the shader programs using this stage (programs copy them)
+		*/
+		template<class T>
+		ShaderStage& Specialize(uint32_t p_constantId, const T& p_value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "specialization constants must be trivially copyable");
+
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				return Specialize(p_constantId, static_cast<VkBool32>(p_value ? VK_TRUE : VK_FALSE));
+			}
+			else
+			{
+				static_assert(IsValidSpecializationConstantSize(sizeof(T)), "specialization constants must be 32 or 64 bits");
+				return Specialize(p_constantId, std::as_bytes(std::span{ &p_value, 1 }));
+			}
+		}
+
+		/**
+		* Sets the value of every specialization constant of a struct, using the map entries the struct declares
+		* (T::GetSpecializationMap(), built at compile time with VAL_SPECIALIZATION_CONSTANT)
+		* @note members are copied as is, so booleans must be declared as VkBool32 (checked at compile time)
+		*/
+		template<SpecializationConstants T>
+		ShaderStage& Specialize(const T& p_constants)
+		{
+			static constexpr auto k_mapEntries = T::GetSpecializationMap();
+
+			static_assert(std::ranges::all_of(k_mapEntries, [](const VkSpecializationMapEntry& p_entry) {
+				return IsValidSpecializationConstantSize(p_entry.size);
+			}), "specialization constants must be 32 or 64 bits (use VkBool32 for booleans)");
+
+			return Specialize(p_constants, std::span<const VkSpecializationMapEntry>(k_mapEntries));
+		}
+
+		/**
+		* Sets the value of specialization constants from a struct, and the map entries describing its members
+		* @note members are copied as is, so booleans must be declared as VkBool32
+		*/
+		template<class T>
+		ShaderStage& Specialize(const T& p_constants, std::span<const VkSpecializationMapEntry> p_mapEntries)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "specialization constants must be trivially copyable");
+
+			const auto bytes = std::as_bytes(std::span{ &p_constants, 1 });
+
+			for (const VkSpecializationMapEntry& mapEntry : p_mapEntries)
+			{
+				assert(mapEntry.offset + mapEntry.size <= bytes.size() && "specialization map entry out of bounds");
+				assert(IsValidSpecializationConstantSize(mapEntry.size) && "specialization constants must be 32 or 64 bits");
+				Specialize(mapEntry.constantID, bytes.subspan(mapEntry.offset, mapEntry.size));
+			}
+
+			return *this;
+		}
+
+		/**
+		* Sets the value of a specialization constant from raw data
+		*/
+		ShaderStage& Specialize(uint32_t p_constantId, std::span<const std::byte> p_data);
+
 		/**
 		* Returns the create info of the shader stage
 		*/
 		const VkPipelineShaderStageCreateInfo& GetCreateInfo() const;
 
+		/**
+		* Returns a hash of the shader stage (shader content, stage, entry point and specialization constants)
+		*/
+		uint64_t GetHash() const;
+
+		/**
+		* Returns the canonical identity of the shader stage, including the whole shader byte code
+		* @note the shader module must still exist
+		*/
+		ShaderStageKey GetKey() const;
+
+	private:
+		void Update();
+
 	private:
+		std::span<const std::byte> m_byteCode;
+		uint64_t m_moduleHash = 0;
+		std::string m_entryPoint;
+		std::vector<VkSpecializationMapEntry> m_specializationMapEntries;
+		std::vector<std::byte> m_specializationData;
+		VkSpecializationInfo m_specializationInfo;
 		VkPipelineShaderStageCreateInfo m_shaderStageCreateInfo;
+		uint64_t m_hash = 0;
 	};
 }
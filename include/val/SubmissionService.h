@@ -0,0 +1,86 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <optional>
+#include <thread>
+#include <val/Queue.h>
+#include <val/SubmitBatch.h>
+#include <val/GpuFuture.h>
+#include <val/sync/Fence.h>
+
+namespace val
+{
+	/**
+	* Owns the submissions to a queue, so it can be used safely from any thread.
+	* Requests are pushed to a lock-free MPSC (multiple producers, single consumer) list, drained by a dedicated
+	* submission thread which merges every request drained in one wake-up into as few vkQueueSubmit2 calls as possible.
+	* @note once a service is created, calls to its queue are forwarded to the service (see Queue), so every component
+	* using the queue directly goes through the submission thread as well
+	* @note a queue can only have one service, which must be created before other threads use the queue
+	*/
+	class SubmissionService
+	{
+	public:
+		using Task = std::function<void(Queue&)>;
+
+		/**
+		* Creates a submission service for the given queue, and starts its submission thread
+		*/
+		SubmissionService(Queue& p_queue);
+
+		/**
+		* Submits every pending request, then stops the submission thread.
+		* Calls to the queue aren't forwarded anymore afterwards.
+		* @note other threads must not use the queue anymore
+		*/
+		virtual ~SubmissionService();
+
+		/**
+		* Requests a batch to be submitted. The fence (if any) is signaled once the batch is complete.
+		* The returned future is ready once the batch has been handed to the driver, and rethrows submission errors.
+		* Its value completes once the batch is complete on the GPU, so it can be awaited from a coroutine:
+		*	co_await service.Submit(std::move(batch)).get();
+		* @note thread-safe, requests are submitted in the order they are pushed
+		* @note batches merged into the same submission share the same GpuFuture
+		*/
+		std::future<GpuFuture> Submit(SubmitBatch p_batch, std::optional<std::reference_wrapper<sync::Fence>> p_fence = std::nullopt);
+
+		/**
+		* Requests a task to be executed on the submission thread, with exclusive access to the queue (e.g. presentation).
+		* The returned future is ready once the task has been executed, and rethrows its errors.
+		* @note thread-safe, the task is executed after every previously pushed request
+		*/
+		std::future<void> Execute(Task p_task);
+
+	private:
+		struct Request
+		{
+			SubmitBatch batch;
+			std::optional<std::reference_wrapper<sync::Fence>> fence;
+			Task task;
+			std::promise<GpuFuture> submitPromise; // For batches
+			std::promise<void> taskPromise; // For tasks
+			bool stop = false;
+			Request* next = nullptr;
+		};
+
+		void Push(Request* p_request);
+		void Run();
+		bool IsSubmissionThread() const;
+
+		friend class Queue;
+
+	private:
+		Queue& m_queue;
+		std::atomic<Request*> m_head = nullptr;
+		std::jthread m_thread;
+	};
+}
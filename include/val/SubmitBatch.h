@@ -0,0 +1,101 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <val/sync/Semaphore.h>
+#include <val/sync/TimelineSemaphore.h>
+
+namespace val
+{
+	class CommandBuffer;
+
+	/**
+	* Accumulates several submissions (command buffers, semaphores to wait for and to signal), each semaphore
+	* with its own stage mask, so they can be flushed to a queue using a single vkQueueSubmit2 call.
+	* @note commands are added to the last submission, started with AddSubmission() (the first one is implicit)
+	*/
+	class SubmitBatch
+	{
+	public:
+		/**
+		* Creates an empty submit batch
+		*/
+		SubmitBatch() = default;
+
+		/**
+		* Destroys the submit batch
+		*/
+		virtual ~SubmitBatch() = default;
+
+		/**
+		* Starts a new submission. Subsequent commands buffers and semaphores are added to it.
+		* @note submissions are executed in order, but only semaphores order them on the GPU timeline
+		*/
+		SubmitBatch& AddSubmission();
+
+		/**
+		* Adds a command buffer to the current submission
+		*/
+		SubmitBatch& AddCommandBuffer(CommandBuffer& p_commandBuffer);
+
+		/**
+		* Makes the current submission wait for a binary semaphore before executing the given stages
+		*/
+		SubmitBatch& Wait(sync::Semaphore& p_semaphore, VkPipelineStageFlags2 p_stages);
+
+		/**
+		* Makes the current submission wait for a timeline semaphore value before executing the given stages
+		*/
+		SubmitBatch& Wait(const sync::TimelineValue& p_value, VkPipelineStageFlags2 p_stages);
+
+		/**
+		* Signals a binary semaphore once the given stages of the current submission are complete
+		*/
+		SubmitBatch& Signal(sync::Semaphore& p_semaphore, VkPipelineStageFlags2 p_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+		/**
+		* Signals a timeline semaphore value once the given stages of the current submission are complete
+		*/
+		SubmitBatch& Signal(const sync::TimelineValue& p_value, VkPipelineStageFlags2 p_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+
+		/**
+		* Appends every submission of another batch, after the submissions of this one
+		*/
+		SubmitBatch& Append(const SubmitBatch& p_other);
+
+		/**
+		* Removes every submission from the batch
+		*/
+		void Clear();
+
+		/**
+		* Returns true if the batch has nothing to submit
+		*/
+		bool IsEmpty() const;
+
+		/**
+		* Returns the list of VkSubmitInfo2 describing the batch
+		* @note the returned structures point to data owned by the batch, which must outlive them (and stay unchanged)
+		*/
+		std::vector<VkSubmitInfo2> GetSubmitInfos() const;
+
+	private:
+		struct Submission
+		{
+			std::vector<VkSemaphoreSubmitInfo> waitSemaphores;
+			std::vector<VkCommandBufferSubmitInfo> commandBuffers;
+			std::vector<VkSemaphoreSubmitInfo> signalSemaphores;
+		};
+
+		Submission& GetCurrentSubmission();
+
+	private:
+		std::vector<Submission> m_submissions;
+	};
+}
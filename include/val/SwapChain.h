@@ -11,6 +11,8 @@
 #include <val/sync/Semaphore.h>
 #include <val/sync/Fence.h>
 #include <val/Framebuffer.h>
+#include <val/Image.h>
+#include <memory>
 #include <stdexcept>
 
 namespace val
@@ -28,11 +30,14 @@ namespace val
 	public:
 		/**
 		* Creates a swap chain
+		* @note if an old swap chain is given, it is retired: its acquired images can still be presented,
+		* and it can be destroyed later on, once its presentations are complete (see FrameScheduler::SetSwapChain())
 		*/
 		SwapChain(
 			Device& p_device,
 			VkSurfaceKHR p_surface,
-			const utils::SwapChainOptimalConfig& p_desc
+			const utils::SwapChainOptimalConfig& p_desc,
+			std::optional<std::reference_wrapper<SwapChain>> p_oldSwapChain = std::nullopt
 		);
 
 		/**
@@ -60,6 +65,16 @@ namespace val
 		*/
 		const std::vector<VkImage>& GetImages() const;
 
+		/**
+		* Returns the swap chain image at the given index, wrapped so its state can be tracked
+		*/
+		Image& GetImage(uint32_t p_index) const;
+
+		/**
+		* Returns swap chain image views
+		*/
+		const std::vector<VkImageView>& GetImageViews() const;
+
 		/**
 		* Returns the swap chain desc
 		*/
@@ -75,6 +90,7 @@ namespace val
 		utils::SwapChainOptimalConfig m_desc;
 		std::vector<VkImage> m_images;
 		std::vector<VkImageView> m_imageViews;
+		std::vector<std::unique_ptr<Image>> m_trackedImages;
 		VkSwapchainKHR m_swapChain = VK_NULL_HANDLE;
 	};
 }
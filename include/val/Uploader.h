@@ -0,0 +1,85 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <val/Buffer.h>
+#include <val/CommandPool.h>
+#include <val/sync/TimelineSemaphore.h>
+
+namespace val
+{
+	class Device;
+	class CommandBuffer;
+
+	/**
+	* Uploads data to device local buffers using the transfer queue, so uploads overlap with rendering.
+	* When the transfer queue belongs to a dedicated family, buffers ownership is released by the transfer queue
+	* and acquired by the graphics queue, which waits for the transfer to complete using a timeline semaphore.
+	* Staging buffers are handed to the device deletion queue, and destroyed once their copies are complete
+	* (when the deletion queue is flushed, e.g. by the FrameScheduler every frame).
+	* @note not thread-safe
+	*/
+	class Uploader
+	{
+	public:
+		/**
+		* Creates an uploader
+		*/
+		Uploader(Device& p_device);
+
+		/**
+		* Destroys the uploader, waiting for pending uploads to complete
+		*/
+		virtual ~Uploader();
+
+		/**
+		* Copies data to a staging buffer, and records its copy to the destination buffer.
+		* Once the upload completes, the destination buffer is owned by the graphics queue, in the given state.
+		* @note the destination buffer content is overwritten, and it must not be in use by the GPU
+		*/
+		void UploadBuffer(Buffer& p_dest, const void* p_data, uint64_t p_size, const sync::ResourceState& p_state);
+
+		/**
+		* Submits every upload recorded since the last flush.
+		* Returns the timeline value signaled once these uploads are complete and usable by the graphics queue.
+		* @note submissions using the uploaded buffers must wait for this value (from the GPU, or from the host)
+		*/
+		sync::TimelineValue Flush();
+
+		/**
+		* Returns the timeline semaphore signaled by upload submissions
+		*/
+		sync::TimelineSemaphore& GetTimeline();
+
+	private:
+		struct UploadBatch
+		{
+			std::reference_wrapper<CommandBuffer> transferCommandBuffer;
+			std::reference_wrapper<CommandBuffer> acquireCommandBuffer; // Same as the transfer one, if no dedicated transfer queue
+			std::vector<std::unique_ptr<Buffer>> stagingBuffers; // Handed to the deletion queue on submission
+			uint64_t completionValue = 0;
+		};
+
+		UploadBatch& GetRecordingBatch();
+		void RecycleCompletedBatches();
+
+	private:
+		Device& m_device;
+		bool m_dedicatedTransferQueue;
+		CommandPool m_transferCommandPool;
+		CommandPool m_graphicsCommandPool;
+		sync::TimelineSemaphore m_timeline;
+		uint64_t m_lastSignaledValue = 0;
+		std::unique_ptr<UploadBatch> m_recordingBatch;
+		std::vector<UploadBatch> m_submittedBatches;
+		std::vector<UploadBatch> m_freeBatches;
+	};
+}
@@ -0,0 +1,75 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <val/Buffer.h>
+
+namespace val
+{
+	class Device;
+	class CommandBuffer;
+	class QueryPool;
+
+	/**
+	* Holds one 32-bit visibility predicate per object, consumed by conditional rendering.
+	* Predicates are written by the GPU (from occlusion query results, or by a compute shader binding the buffer
+	* as a storage buffer), so invisible objects are skipped without any CPU readback.
+	* @note every object is visible until the first predicates are written
+	*/
+	class VisibilityBuffer
+	{
+	public:
+		/**
+		* Creates a visibility buffer for the given number of objects
+		*/
+		VisibilityBuffer(Device& p_device, uint32_t p_objectCount);
+
+		/**
+		* Destroys the visibility buffer
+		*/
+		virtual ~VisibilityBuffer() = default;
+
+		/**
+		* Writes the results of a range of occlusion queries as the predicates of a range of objects
+		* (one query per object). The copy waits on the GPU for the queries to complete.
+		* @note must be recorded outside of a render pass
+		*/
+		void ResolveOcclusionQueries(
+			CommandBuffer& p_commandBuffer,
+			QueryPool& p_queryPool,
+			uint32_t p_firstQuery,
+			uint32_t p_queryCount,
+			uint32_t p_firstObject = 0
+		);
+
+		/**
+		* Begins a conditional rendering block, only executing the following draws if the given object is visible
+		* (or invisible, if inverted)
+		*/
+		void BeginConditionalRendering(CommandBuffer& p_commandBuffer, uint32_t p_object, bool p_inverted = false);
+
+		/**
+		* Returns the offset of the predicate of the given object
+		*/
+		uint64_t GetOffset(uint32_t p_object) const;
+
+		/**
+		* Returns the number of objects
+		*/
+		uint32_t GetObjectCount() const;
+
+		/**
+		* Returns the buffer holding the predicates (e.g. to be bound as a storage buffer by a compute shader)
+		*/
+		Buffer& GetBuffer();
+
+	private:
+		uint32_t m_objectCount;
+		Buffer m_buffer;
+	};
+}
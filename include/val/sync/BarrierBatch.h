@@ -0,0 +1,102 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <val/sync/ResourceState.h>
+
+namespace val::sync
+{
+	/**
+	* Accumulates buffer and image memory barriers, so they can be emitted together
+	* with a single vkCmdPipelineBarrier2 call.
+	* @note A barrier already pending for a resource is extended by the next transitions of that resource,
+	* so every stage using it before the batch is flushed is synchronized with its last write.
+	*/
+	class BarrierBatch
+	{
+	public:
+		/**
+		* Returns true if the given access mask contains any write access
+		*/
+		static bool IsWriteAccess(VkAccessFlags2 p_accessMask);
+
+		/**
+		* Requests a transition of a buffer from its current state to the target state.
+		* The current state is updated to reflect the target state.
+		* Returns true if a barrier had to be added to the batch.
+		*/
+		bool AddBufferTransition(
+			VkBuffer p_buffer,
+			ResourceState& p_currentState,
+			const ResourceState& p_targetState,
+			VkDeviceSize p_offset = 0,
+			VkDeviceSize p_size = VK_WHOLE_SIZE
+		);
+
+		/**
+		* Requests a transition of an image from its current state (and layout) to the target state.
+		* The current state is updated to reflect the target state.
+		* Returns true if a barrier had to be added to the batch.
+		*/
+		bool AddImageTransition(
+			VkImage p_image,
+			ResourceState& p_currentState,
+			const ResourceState& p_targetState,
+			const VkImageSubresourceRange& p_subresourceRange
+		);
+
+		/**
+		* Requests a queue family ownership transfer of a buffer. The same barrier must be recorded on both queues:
+		* first on the source queue (release, with a target state without stage nor access),
+		* then on the destination queue (acquire, from a state without stage nor access).
+		* The current state is updated to reflect the target state.
+		*/
+		void AddBufferOwnershipTransfer(
+			VkBuffer p_buffer,
+			ResourceState& p_currentState,
+			const ResourceState& p_targetState,
+			uint32_t p_srcQueueFamilyIndex,
+			uint32_t p_dstQueueFamilyIndex
+		);
+
+		/**
+		* Requests a queue family ownership transfer of an image, recorded on both queues like a buffer transfer.
+		* A layout transition can be performed at the same time, in which case the release and the acquire must
+		* use the same layouts (the release targets the new layout, the acquire starts from the old one).
+		* The current state is updated to reflect the target state.
+		*/
+		void AddImageOwnershipTransfer(
+			VkImage p_image,
+			ResourceState& p_currentState,
+			const ResourceState& p_targetState,
+			const VkImageSubresourceRange& p_subresourceRange,
+			uint32_t p_srcQueueFamilyIndex,
+			uint32_t p_dstQueueFamilyIndex
+		);
+
+		/**
+		* Returns true if no barrier is pending
+		*/
+		bool IsEmpty() const;
+
+		/**
+		* Records all pending barriers into the given command buffer, and clears the batch
+		*/
+		void Flush(VkCommandBuffer p_commandBuffer);
+
+		/**
+		* Discards all pending barriers
+		*/
+		void Clear();
+
+	private:
+		std::vector<VkBufferMemoryBarrier2> m_bufferBarriers;
+		std::vector<VkImageMemoryBarrier2> m_imageBarriers;
+	};
+}
@@ -0,0 +1,57 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <val/sync/Fence.h>
+
+namespace val::sync
+{
+	/**
+	* Hands out recycled fences, to avoid paying creation and destruction for each transient submission.
+	* Released fences are recycled once signaled, and reset in batches using a single vkResetFences call.
+	* @note thread-safe
+	*/
+	class FencePool
+	{
+	public:
+		/**
+		* Creates an empty fence pool
+		*/
+		FencePool(VkDevice p_device);
+
+		/**
+		* Destroys the fence pool, and every fence it created
+		* @note fences must not be in use by the GPU anymore
+		*/
+		virtual ~FencePool() = default;
+
+		/**
+		* Returns an unsignaled fence, recycled if possible
+		*/
+		Fence& Acquire();
+
+		/**
+		* Gives a fence back to the pool. It will be recycled once signaled.
+		* @note the fence must have been submitted (an unsignaled fence that is never submitted is never recycled)
+		*/
+		void Release(Fence& p_fence);
+
+	private:
+		void RecycleSignaledFences();
+
+	private:
+		VkDevice m_device = VK_NULL_HANDLE;
+		std::mutex m_mutex;
+		std::vector<std::unique_ptr<Fence>> m_fences;
+		std::vector<Fence*> m_availableFences;
+		std::vector<Fence*> m_releasedFences;
+	};
+}
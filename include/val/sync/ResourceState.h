@@ -0,0 +1,29 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace val::sync
+{
+	/**
+	* Describes how a resource was last accessed by the GPU (or how it is about to be accessed).
+	* Used to deduce the pipeline barriers required between two usages of the same resource.
+	* @note When used as a target state, only the stage mask, access mask and layout are relevant.
+	* The remaining fields are maintained by the BarrierBatch to track the last write of the resource.
+	*/
+	struct ResourceState
+	{
+		VkPipelineStageFlags2 stageMask = VK_PIPELINE_STAGE_2_NONE; // Every stage that accessed the resource since its last write
+		VkAccessFlags2 accessMask = VK_ACCESS_2_NONE; // Every access to the resource since its last write
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED; // Ignored for buffers
+		VkPipelineStageFlags2 writeStageMask = VK_PIPELINE_STAGE_2_NONE; // Stage of the last write (or of the barrier that synchronized it)
+		VkAccessFlags2 writeAccessMask = VK_ACCESS_2_NONE; // Write access still to be made available, if any
+		VkPipelineStageFlags2 visibleStageMask = VK_PIPELINE_STAGE_2_NONE; // Stages the last write has already been made visible to
+		VkAccessFlags2 visibleAccessMask = VK_ACCESS_2_NONE; // Accesses the last write has already been made visible to
+	};
+}
@@ -0,0 +1,66 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <val/sync/Semaphore.h>
+#include <val/sync/TimelineSemaphore.h>
+
+namespace val::sync
+{
+	/**
+	* Hands out recycled binary semaphores, to avoid paying creation and destruction for each transient submission.
+	* Binary semaphores can't be queried, so released semaphores are recycled once a given timeline point retires.
+	* @note thread-safe
+	*/
+	class SemaphorePool
+	{
+	public:
+		/**
+		* Creates an empty semaphore pool
+		*/
+		SemaphorePool(VkDevice p_device);
+
+		/**
+		* Destroys the semaphore pool, and every semaphore it created
+		* @note semaphores must not be in use by the GPU anymore
+		*/
+		virtual ~SemaphorePool() = default;
+
+		/**
+		* Returns an unsignaled binary semaphore, recycled if possible
+		*/
+		Semaphore& Acquire();
+
+		/**
+		* Gives a semaphore back to the pool. It will be recycled once the given timeline value is reached,
+		* which must be signaled after the submission waiting for the semaphore (if not set, the semaphore is recycled immediately).
+		* @note a semaphore must be unsignaled when released (its last signal operation has been waited for)
+		*/
+		void Release(Semaphore& p_semaphore, std::optional<TimelineValue> p_retireValue = std::nullopt);
+
+	private:
+		struct ReleasedSemaphore
+		{
+			Semaphore* semaphore;
+			TimelineValue retireValue;
+		};
+
+		void RecycleRetiredSemaphores();
+
+	private:
+		VkDevice m_device = VK_NULL_HANDLE;
+		std::mutex m_mutex;
+		std::vector<std::unique_ptr<Semaphore>> m_semaphores;
+		std::vector<Semaphore*> m_availableSemaphores;
+		std::vector<ReleasedSemaphore> m_releasedSemaphores;
+	};
+}
@@ -0,0 +1,87 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <functional>
+#include <optional>
+
+namespace val::sync
+{
+	class TimelineSemaphore;
+
+	/**
+	* A point on a timeline semaphore (used to wait for, or signal, a given value)
+	*/
+	struct TimelineValue
+	{
+		std::reference_wrapper<TimelineSemaphore> semaphore;
+		uint64_t value;
+	};
+
+	/**
+	* Semaphore holding a monotonically increasing 64-bit counter, which can be signaled and waited on
+	* from both the host and the GPU
+	*/
+	class TimelineSemaphore
+	{
+	public:
+		/**
+		* Creates a timeline semaphore
+		*/
+		TimelineSemaphore(VkDevice p_device, uint64_t p_initialValue = 0);
+
+		/**
+		* Destroys the timeline semaphore
+		*/
+		virtual ~TimelineSemaphore();
+
+		/**
+		* Sets the counter to the given value from the host
+		* @note the value must be greater than the current value
+		*/
+		void Signal(uint64_t p_value);
+
+		/**
+		* Waits for the counter to reach (at least) the given value.
+		* Returns false if the timeout expired before the value was reached.
+		*/
+		bool Wait(uint64_t p_value, std::optional<uint64_t> p_timeout = std::nullopt) const;
+
+		/**
+		* Returns the current value of the counter
+		*/
+		uint64_t GetValue() const;
+
+		/**
+		* Returns the underlying VkSemaphore handle
+		*/
+		VkSemaphore GetHandle() const;
+
+	private:
+		VkDevice m_device = VK_NULL_HANDLE;
+		VkSemaphore m_handle = VK_NULL_HANDLE;
+	};
+
+	/**
+	* Tells if timeline values are reached, without waiting.
+	* Values checked in a row usually share the same timeline (e.g. resources retired by frames), so the counter of a timeline
+	* is only queried again when a value of another timeline is checked in between.
+	*/
+	class TimelineValueChecker
+	{
+	public:
+		/**
+		* Returns true if the timeline of the given value has reached it
+		*/
+		bool IsReached(const TimelineValue& p_value);
+
+	private:
+		const TimelineSemaphore* m_lastTimeline = nullptr;
+		uint64_t m_lastTimelineValue = 0;
+	};
+}
@@ -0,0 +1,71 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace val::sync
+{
+	/**
+	* How the host waits for fences and timeline semaphores.
+	* Spinning avoids the OS wake-up delay following a blocking wait, at the cost of a busy CPU core.
+	*/
+	struct WaitStrategy
+	{
+		uint64_t spinBudgetNs = 0; // Time spent polling before falling back to a blocking wait (0: block immediately)
+		bool yieldWhileSpinning = false; // Yields the thread between polls, to leave the core to other threads
+	};
+
+	/**
+	* Distribution of host wait times, to pick the right wait strategy per deployment.
+	* Bucket i counts waits which lasted less than 2^i microseconds (the last bucket counts every longer wait).
+	* @note thread-safe
+	*/
+	class WaitHistogram
+	{
+	public:
+		static constexpr uint32_t k_bucketCount = 24;
+
+		/**
+		* Records a wait
+		* @note p_blocked must be true if the wait ended with a blocking wait (spin budget exceeded)
+		*/
+		void Record(uint64_t p_durationNs, bool p_blocked);
+
+		/**
+		* Returns the number of waits recorded in the given bucket
+		*/
+		uint64_t GetBucket(uint32_t p_index) const;
+
+		/**
+		* Returns the (exclusive) upper bound of the given bucket, in nanoseconds
+		*/
+		static uint64_t GetBucketUpperBoundNs(uint32_t p_index);
+
+		/**
+		* Returns the number of waits completed while spinning
+		*/
+		uint64_t GetSpinCompletedCount() const;
+
+		/**
+		* Returns the number of waits which had to block
+		*/
+		uint64_t GetBlockedCount() const;
+
+		/**
+		* Clears every recorded wait
+		*/
+		void Reset();
+
+	private:
+		std::array<std::atomic<uint64_t>, k_bucketCount> m_buckets{};
+		std::atomic<uint64_t> m_spinCompletedCount = 0;
+		std::atomic<uint64_t> m_blockedCount = 0;
+	};
+}
@@ -0,0 +1,85 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace val::utils
+{
+	/**
+	* Records CPU scopes into per-thread ring buffers. Recording is lock-free: each thread only writes to its own ring,
+	* and rings are only locked when a thread records its first scope (registration).
+	* @note scopes should be declared using VAL_PROFILE_SCOPE / VAL_PROFILE_FUNCTION, which are compiled out
+	* unless VAL_PROFILING is defined
+	*/
+	class CpuProfiler
+	{
+	public:
+		// Number of scopes kept per thread (oldest scopes are overwritten)
+		static constexpr uint32_t k_ringSize = 16384;
+
+		/**
+		* Measures the lifetime of a scope
+		*/
+		class Scope
+		{
+		public:
+			/**
+			* Starts measuring a scope
+			* @note p_name must outlive the profiler (e.g. a string literal)
+			*/
+			Scope(const char* p_name);
+
+			/**
+			* Stops measuring the scope, and records it
+			*/
+			~Scope();
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			const char* m_name;
+			uint64_t m_start;
+		};
+
+		/**
+		* Records a scope for the calling thread
+		* @note p_name must outlive the profiler (e.g. a string literal)
+		*/
+		static void Record(const char* p_name, uint64_t p_start, uint64_t p_end);
+
+		/**
+		* Returns the current time in nanoseconds (steady clock)
+		*/
+		static uint64_t Now();
+
+		/**
+		* Returns every scope recorded by every thread as a Chrome trace (JSON), which can be loaded in chrome://tracing or Perfetto
+		* @note can be called while other threads are recording. Scopes being overwritten during the export are skipped.
+		*/
+		static std::string ExportChromeTrace();
+
+		/**
+		* Returns the given string escaped to be written inside a JSON string (quotes, backslashes and control characters)
+		* @note shared by the CPU and GPU trace exports
+		*/
+		static std::string EscapeJson(std::string_view p_value);
+	};
+}
+
+#if defined(VAL_PROFILING)
+#define VAL_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VAL_PROFILE_CONCAT(a, b) VAL_PROFILE_CONCAT_IMPL(a, b)
+#define VAL_PROFILE_SCOPE(name) ::val::utils::CpuProfiler::Scope VAL_PROFILE_CONCAT(valProfileScope, __LINE__)(name)
+#define VAL_PROFILE_FUNCTION() VAL_PROFILE_SCOPE(__FUNCTION__)
+#else
+#define VAL_PROFILE_SCOPE(name)
+#define VAL_PROFILE_FUNCTION()
+#endif
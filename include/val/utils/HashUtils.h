@@ -0,0 +1,77 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace val::utils
+{
+	class HashUtils
+	{
+	public:
+		/**
+		* Returns a 64-bit hash of the given bytes (FNV-1a)
+		* @note stable across runs, so it can be used to identify content (e.g. shader byte code)
+		*/
+		static uint64_t HashBytes(std::span<const std::byte> p_bytes, uint64_t p_seed = k_offsetBasis);
+
+		/**
+		* Combines the given value into the seed
+		* @note the value is hashed byte by byte, so it must not contain padding (or floats, since 0.0f and -0.0f differ)
+		*/
+		template<class T>
+		static void Combine(uint64_t& p_seed, const T& p_value)
+		{
+			static_assert(std::has_unique_object_representations_v<T>, "hashed values must not contain padding bytes");
+
+			p_seed = HashBytes(std::as_bytes(std::span{ &p_value, 1 }), p_seed);
+		}
+
+		/**
+		* Combines each element of the given range into the seed, prefixed by the range size
+		*/
+		template<class T>
+		static void CombineRange(uint64_t& p_seed, std::span<const T> p_values)
+		{
+			static_assert(std::has_unique_object_representations_v<T>, "hashed values must not contain padding bytes");
+
+			Combine(p_seed, static_cast<uint64_t>(p_values.size()));
+			p_seed = HashBytes(std::as_bytes(p_values), p_seed);
+		}
+
+		/**
+		* Appends the bytes of the given value to a key (exact counterpart of Combine, for equality comparisons)
+		*/
+		template<class T>
+		static void Append(std::vector<std::byte>& p_key, const T& p_value)
+		{
+			static_assert(std::has_unique_object_representations_v<T>, "key values must not contain padding bytes");
+
+			const auto bytes = std::as_bytes(std::span{ &p_value, 1 });
+			p_key.insert(p_key.end(), bytes.begin(), bytes.end());
+		}
+
+		/**
+		* Appends each element of the given range to a key, prefixed by the range size
+		*/
+		template<class T>
+		static void AppendRange(std::vector<std::byte>& p_key, std::span<const T> p_values)
+		{
+			static_assert(std::has_unique_object_representations_v<T>, "key values must not contain padding bytes");
+
+			Append(p_key, static_cast<uint64_t>(p_values.size()));
+			const auto bytes = std::as_bytes(p_values);
+			p_key.insert(p_key.end(), bytes.begin(), bytes.end());
+		}
+
+	private:
+		static constexpr uint64_t k_offsetBasis = 14695981039346656037ull;
+	};
+}
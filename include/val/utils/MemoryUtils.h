@@ -15,6 +15,11 @@ namespace val::utils
 	class MemoryUtils
 	{
 	public:
+		/**
+		* Returns the index of a memory type matching the type filter and the requested properties
+		*/
+		static uint32_t FindMemoryType(VkPhysicalDevice p_physicalDevice, uint32_t p_typeFilter, VkMemoryPropertyFlags p_properties);
+
 		// Input need to be a class with GetHandle() (VkObject)
 		template<class Output, class Input>
 		static std::vector<Output> PrepareArray(std::initializer_list<std::reference_wrapper<Input>> p_elements)
@@ -0,0 +1,60 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace val::utils
+{
+	/**
+	* Fixed-size pool of worker threads executing tasks in FIFO order (e.g. pipeline compilation)
+	* @note thread-safe
+	*/
+	class ThreadPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		/**
+		* Creates a thread pool with the given number of workers.
+		* If 0, one worker is created per hardware thread, minus one for the calling thread (at least one worker).
+		*/
+		ThreadPool(uint32_t p_threadCount = 0);
+
+		/**
+		* Executes every pending task, then stops the workers
+		*/
+		virtual ~ThreadPool();
+
+		/**
+		* Enqueues a task, executed by the first available worker
+		* @note tasks must not throw
+		*/
+		void Enqueue(Task p_task);
+
+		/**
+		* Returns the number of workers
+		*/
+		uint32_t GetThreadCount() const;
+
+	private:
+		void Run();
+
+	private:
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		std::deque<Task> m_tasks;
+		bool m_stopping = false;
+		std::vector<std::jthread> m_threads;
+	};
+}
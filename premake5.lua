@@ -26,7 +26,7 @@ project "val"
     }
 
     filter "configurations:Debug"
-        defines { "DEBUG" }
+        defines { "DEBUG", "VAL_PROFILING" }
         symbols "On"
 
     filter "configurations:Release"
@@ -6,34 +6,19 @@
 
 #include <val/Buffer.h>
 #include <val/Device.h>
+#include <val/utils/MemoryUtils.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
 
-namespace
-{
-	uint32_t FindMemoryType(VkPhysicalDevice p_physicalDevice, uint32_t p_typeFilter, VkMemoryPropertyFlags p_properties)
-	{
-		VkPhysicalDeviceMemoryProperties memProperties;
-		vkGetPhysicalDeviceMemoryProperties(p_physicalDevice, &memProperties);
-
-		for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-		{
-			if ((p_typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & p_properties) == p_properties)
-			{
-				return i;
-			}
-		}
-
-		throw std::runtime_error("failed to find suitable memory type!");
-	}
-}
-
 namespace val
 {
 	Buffer::Buffer(Device& p_device, const BufferDesc& p_desc) :
 		m_device(p_device)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		VkBufferCreateInfo bufferInfo{
 			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
 			.size = p_desc.size,
@@ -71,12 +56,14 @@ namespace val
 
 	void Buffer::Allocate(VkMemoryPropertyFlags p_properties)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		assert(!IsAllocated());
 
 		VkMemoryRequirements memRequirements;
 		vkGetBufferMemoryRequirements(m_device.GetLogicalDevice(), m_handle, &memRequirements);
 
-		const auto memoryType = FindMemoryType(
+		const auto memoryType = utils::MemoryUtils::FindMemoryType(
 			m_device.GetPhysicalDevice(),
 			memRequirements.memoryTypeBits,
 			p_properties
@@ -105,6 +92,8 @@ namespace val
 
 	void Buffer::Deallocate()
 	{
+		VAL_PROFILE_FUNCTION();
+
 		assert(IsAllocated());
 
 		vkFreeMemory(m_device.GetLogicalDevice(), m_memory, nullptr);
@@ -114,6 +103,8 @@ namespace val
 
 	void Buffer::Upload(const void* p_data, std::optional<BufferMemoryRange> p_memoryRange)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		assert(IsAllocated());
 		assert(!p_memoryRange.has_value() || p_memoryRange->offset + p_memoryRange->size <= m_allocatedBytes); // out-of-bounds check
 
@@ -149,4 +140,14 @@ namespace val
 	{
 		return m_handle;
 	}
+
+	const sync::ResourceState& Buffer::GetState() const
+	{
+		return m_state;
+	}
+
+	void Buffer::SetState(const sync::ResourceState& p_state)
+	{
+		m_state = p_state;
+	}
 }
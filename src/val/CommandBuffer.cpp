@@ -5,16 +5,23 @@
 */
 
 #include <val/CommandBuffer.h>
+#include <val/Device.h>
 #include <val/Buffer.h>
+#include <val/Image.h>
 #include <val/DescriptorSet.h>
+#include <val/GraphicsPipeline.h>
+#include <val/ComputePipeline.h>
+#include <val/QueryPool.h>
 #include <val/utils/MemoryUtils.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
 
 namespace val
 {
-	CommandBuffer::CommandBuffer(VkCommandBuffer p_commandBuffer) :
+	CommandBuffer::CommandBuffer(Device& p_device, VkCommandBuffer p_commandBuffer) :
+		m_device(p_device),
 		m_handle(p_commandBuffer)
 	{
 	}
@@ -26,11 +33,19 @@ namespace val
 
 	void CommandBuffer::Reset()
 	{
+		VAL_PROFILE_FUNCTION();
+
 		vkResetCommandBuffer(m_handle, 0);
 	}
 
 	void CommandBuffer::Begin(VkCommandBufferUsageFlags p_flags)
 	{
+		VAL_PROFILE_FUNCTION();
+
+		m_pendingBarriers.Clear();
+		m_insideRenderPass = false;
+		m_boundPipelineLayout = VK_NULL_HANDLE;
+
 		VkCommandBufferBeginInfo beginInfo{
 			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
 			.flags = p_flags,
@@ -43,20 +58,143 @@ namespace val
 		}
 	}
 
+	void CommandBuffer::Begin(VkCommandBufferUsageFlags p_flags, const VkCommandBufferInheritanceInfo& p_inheritanceInfo)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		m_pendingBarriers.Clear();
+		m_insideRenderPass = (p_flags & VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT) != 0;
+		m_boundPipelineLayout = VK_NULL_HANDLE;
+
+		VkCommandBufferBeginInfo beginInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.flags = p_flags,
+			.pInheritanceInfo = &p_inheritanceInfo
+		};
+
+		if (vkBeginCommandBuffer(m_handle, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to begin recording command buffer!");
+		}
+	}
+
 	void CommandBuffer::End()
 	{
+		VAL_PROFILE_FUNCTION();
+
+		FlushBarriers();
+
 		if (vkEndCommandBuffer(m_handle) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to record command buffer!");
 		}
 	}
 
+	void CommandBuffer::TransitionBuffer(Buffer& p_buffer, const sync::ResourceState& p_state)
+	{
+		if (!m_resourceStateTracking)
+		{
+			return;
+		}
+
+		const bool barrierAdded = m_pendingBarriers.AddBufferTransition(
+			p_buffer.GetHandle(),
+			p_buffer.m_state,
+			p_state
+		);
+
+		assert(!(barrierAdded && m_insideRenderPass) && "buffer must be transitioned before the render pass begins");
+	}
+
+	void CommandBuffer::TransitionImage(Image& p_image, const sync::ResourceState& p_state)
+	{
+		if (!m_resourceStateTracking)
+		{
+			return;
+		}
+
+		const bool barrierAdded = m_pendingBarriers.AddImageTransition(
+			p_image.GetHandle(),
+			p_image.m_state,
+			p_state,
+			p_image.GetSubresourceRange()
+		);
+
+		assert(!(barrierAdded && m_insideRenderPass) && "image must be transitioned before the render pass begins");
+	}
+
+	void CommandBuffer::ReleaseBufferOwnership(Buffer& p_buffer, uint32_t p_srcQueueFamilyIndex, uint32_t p_dstQueueFamilyIndex)
+	{
+		if (p_srcQueueFamilyIndex == p_dstQueueFamilyIndex)
+		{
+			return;
+		}
+
+		assert(!m_insideRenderPass && "buffer ownership must be released outside of a render pass");
+
+		// The destination stage and access are ignored by the release, the acquire defines them
+		m_pendingBarriers.AddBufferOwnershipTransfer(
+			p_buffer.GetHandle(),
+			p_buffer.m_state,
+			sync::ResourceState{},
+			p_srcQueueFamilyIndex,
+			p_dstQueueFamilyIndex
+		);
+	}
+
+	void CommandBuffer::AcquireBufferOwnership(
+		Buffer& p_buffer,
+		uint32_t p_srcQueueFamilyIndex,
+		uint32_t p_dstQueueFamilyIndex,
+		const sync::ResourceState& p_state
+	)
+	{
+		if (p_srcQueueFamilyIndex == p_dstQueueFamilyIndex)
+		{
+			TransitionBuffer(p_buffer, p_state);
+			return;
+		}
+
+		assert(!m_insideRenderPass && "buffer ownership must be acquired outside of a render pass");
+
+		// The source stage and access are ignored by the acquire, the release (and the semaphore) define them
+		sync::ResourceState releasedState{};
+
+		m_pendingBarriers.AddBufferOwnershipTransfer(
+			p_buffer.GetHandle(),
+			releasedState,
+			p_state,
+			p_srcQueueFamilyIndex,
+			p_dstQueueFamilyIndex
+		);
+
+		p_buffer.m_state = releasedState;
+	}
+
+	void CommandBuffer::SetResourceStateTracking(bool p_enabled)
+	{
+		m_resourceStateTracking = p_enabled;
+	}
+
+	void CommandBuffer::FlushBarriers()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(!m_insideRenderPass || m_pendingBarriers.IsEmpty());
+		m_pendingBarriers.Flush(m_handle);
+	}
+
 	void CommandBuffer::BeginRenderPass(
 		VkRenderPass p_renderPass,
 		VkFramebuffer p_framebuffer,
-		VkExtent2D p_extent
+		VkExtent2D p_extent,
+		VkSubpassContents p_contents
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
+		FlushBarriers();
+
 		VkClearValue clearColor = { {
 			{ 0.0f, 0.0f, 0.0f, 1.0f }
 		} };
@@ -76,17 +214,173 @@ namespace val
 		vkCmdBeginRenderPass(
 			m_handle,
 			&renderPassInfo,
-			VK_SUBPASS_CONTENTS_INLINE
+			p_contents
 		);
+
+		m_insideRenderPass = true;
 	}
 
 	void CommandBuffer::EndRenderPass()
 	{
+		VAL_PROFILE_FUNCTION();
+
 		vkCmdEndRenderPass(m_handle);
+		m_insideRenderPass = false;
+	}
+
+	void CommandBuffer::BeginRendering(
+		std::span<const VkRenderingAttachmentInfo> p_colorAttachments,
+		std::optional<VkRenderingAttachmentInfo> p_depthAttachment,
+		VkExtent2D p_extent,
+		VkRenderingFlags p_flags
+	)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		FlushBarriers();
+
+		VkRenderingInfo renderingInfo{
+			.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+			.flags = p_flags,
+			.renderArea = {
+				.offset = { 0, 0 },
+				.extent = p_extent
+			},
+			.layerCount = 1,
+			.colorAttachmentCount = static_cast<uint32_t>(p_colorAttachments.size()),
+			.pColorAttachments = p_colorAttachments.data(),
+			.pDepthAttachment = p_depthAttachment.has_value() ? &p_depthAttachment.value() : nullptr
+		};
+
+		vkCmdBeginRendering(m_handle, &renderingInfo);
+
+		m_insideRenderPass = true;
+	}
+
+	void CommandBuffer::EndRendering()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdEndRendering(m_handle);
+		m_insideRenderPass = false;
+	}
+
+	void CommandBuffer::ExecuteCommands(std::span<const std::reference_wrapper<CommandBuffer>> p_commandBuffers)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		FlushBarriers();
+
+		const auto commandBuffers = utils::MemoryUtils::PrepareArray<VkCommandBuffer>(p_commandBuffers);
+
+		vkCmdExecuteCommands(
+			m_handle,
+			static_cast<uint32_t>(commandBuffers.size()),
+			commandBuffers.data()
+		);
+	}
+
+	void CommandBuffer::ResetQueryPool(QueryPool& p_queryPool, uint32_t p_firstQuery, uint32_t p_queryCount)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(!m_insideRenderPass && "query pools cannot be reset inside a render pass");
+		assert(p_firstQuery + p_queryCount <= p_queryPool.GetDesc().count);
+		vkCmdResetQueryPool(m_handle, p_queryPool.GetHandle(), p_firstQuery, p_queryCount);
+	}
+
+	void CommandBuffer::BeginQuery(QueryPool& p_queryPool, uint32_t p_query, VkQueryControlFlags p_flags)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_queryPool.GetDesc().type != VK_QUERY_TYPE_TIMESTAMP && "timestamp queries must be written with WriteTimestamp()");
+		vkCmdBeginQuery(m_handle, p_queryPool.GetHandle(), p_query, p_flags);
+	}
+
+	void CommandBuffer::EndQuery(QueryPool& p_queryPool, uint32_t p_query)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdEndQuery(m_handle, p_queryPool.GetHandle(), p_query);
+	}
+
+	void CommandBuffer::CopyQueryPoolResults(
+		QueryPool& p_queryPool,
+		uint32_t p_firstQuery,
+		uint32_t p_queryCount,
+		Buffer& p_dest,
+		uint64_t p_destOffset,
+		uint64_t p_stride,
+		VkQueryResultFlags p_flags
+	)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(!m_insideRenderPass && "query results cannot be copied inside a render pass");
+
+		TransitionBuffer(p_dest, { VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT });
+		FlushBarriers();
+
+		vkCmdCopyQueryPoolResults(
+			m_handle,
+			p_queryPool.GetHandle(),
+			p_firstQuery,
+			p_queryCount,
+			p_dest.GetHandle(),
+			p_destOffset,
+			p_stride,
+			p_flags
+		);
+	}
+
+	void CommandBuffer::BeginConditionalRendering(Buffer& p_buffer, uint64_t p_offset, bool p_inverted)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_offset % 4 == 0 && "conditional rendering offset must be a multiple of 4");
+
+		TransitionBuffer(p_buffer, { VK_PIPELINE_STAGE_2_CONDITIONAL_RENDERING_BIT_EXT, VK_ACCESS_2_CONDITIONAL_RENDERING_READ_BIT_EXT });
+		FlushBarriers();
+
+		VkConditionalRenderingBeginInfoEXT beginInfo{
+			.sType = VK_STRUCTURE_TYPE_CONDITIONAL_RENDERING_BEGIN_INFO_EXT,
+			.buffer = p_buffer.GetHandle(),
+			.offset = p_offset,
+			.flags = p_inverted ? VK_CONDITIONAL_RENDERING_INVERTED_BIT_EXT : 0U
+		};
+
+		const auto func = m_device.GetDispatch().vkCmdBeginConditionalRenderingEXT;
+
+		assert(func != nullptr && "conditional rendering isn't supported");
+		func(m_handle, &beginInfo);
+	}
+
+	void CommandBuffer::EndConditionalRendering()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const auto func = m_device.GetDispatch().vkCmdEndConditionalRenderingEXT;
+
+		assert(func != nullptr && "conditional rendering isn't supported");
+		func(m_handle);
+	}
+
+	void CommandBuffer::WriteTimestamp(QueryPool& p_queryPool, uint32_t p_query, VkPipelineStageFlags2 p_stage)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_queryPool.GetDesc().type == VK_QUERY_TYPE_TIMESTAMP);
+		vkCmdWriteTimestamp2(m_handle, p_stage, p_queryPool.GetHandle(), p_query);
 	}
 
 	void CommandBuffer::CopyBuffer(Buffer& p_src, Buffer& p_dest, std::span<const VkBufferCopy> p_regions)
 	{
+		VAL_PROFILE_FUNCTION();
+
+		TransitionBuffer(p_src, { VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_READ_BIT });
+		TransitionBuffer(p_dest, { VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT });
+		FlushBarriers();
+
 		VkBufferCopy defaultRegion{
 			.size = std::min(p_src.GetAllocatedBytes(), p_dest.GetAllocatedBytes())
 		};
@@ -107,11 +401,51 @@ namespace val
 
 	void CommandBuffer::BindPipeline(VkPipelineBindPoint p_bindPoint, VkPipeline p_pipeline)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		vkCmdBindPipeline(m_handle, p_bindPoint, p_pipeline);
 	}
 
-	void CommandBuffer::BindIndexBuffer(const Buffer& p_indexBuffer, uint64_t p_offset, VkIndexType p_indexType)
+	void CommandBuffer::BindPipeline(const GraphicsPipeline& p_pipeline)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, p_pipeline.GetHandle());
+		m_boundPipelineLayout = p_pipeline.GetLayout();
+	}
+
+	void CommandBuffer::BindPipeline(const ComputePipeline& p_pipeline)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		BindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, p_pipeline.GetHandle());
+		m_boundPipelineLayout = p_pipeline.GetLayout();
+	}
+
+	void CommandBuffer::PushConstants(VkShaderStageFlags p_stages, uint32_t p_offset, uint32_t p_size, const void* p_data)
 	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(m_boundPipelineLayout != VK_NULL_HANDLE && "a pipeline must be bound before updating push constants");
+		assert(p_offset % 4 == 0 && "push constants offset must be a multiple of 4");
+		assert(p_offset + p_size <= k_maxPushConstantsSize && "push constants exceed the guaranteed limit");
+
+		vkCmdPushConstants(
+			m_handle,
+			m_boundPipelineLayout,
+			p_stages,
+			p_offset,
+			p_size,
+			p_data
+		);
+	}
+
+	void CommandBuffer::BindIndexBuffer(Buffer& p_indexBuffer, uint64_t p_offset, VkIndexType p_indexType)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		TransitionBuffer(p_indexBuffer, { VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT });
+
 		vkCmdBindIndexBuffer(
 			m_handle,
 			p_indexBuffer.GetHandle(),
@@ -125,6 +459,13 @@ namespace val
 		std::span<const uint64_t> p_offsets
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
+		for (auto& buffer : p_buffers)
+		{
+			TransitionBuffer(buffer, { VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT });
+		}
+
 		std::vector<VkBuffer> buffers = utils::MemoryUtils::PrepareArray<VkBuffer>(p_buffers);
 
 		vkCmdBindVertexBuffers(
@@ -138,14 +479,17 @@ namespace val
 
 	void CommandBuffer::BindDescriptorSets(
 		std::span<const std::reference_wrapper<DescriptorSet>> p_descriptorSets,
-		VkPipelineLayout p_pipelineLayout
+		VkPipelineLayout p_pipelineLayout,
+		VkPipelineBindPoint p_bindPoint
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<VkDescriptorSet> descriptorSets = utils::MemoryUtils::PrepareArray<VkDescriptorSet>(p_descriptorSets);
 
 		vkCmdBindDescriptorSets(
 			m_handle,
-			VK_PIPELINE_BIND_POINT_GRAPHICS,
+			p_bindPoint,
 			p_pipelineLayout,
 			0,
 			1,
@@ -157,21 +501,202 @@ namespace val
 
 	void CommandBuffer::SetViewport(const VkViewport& p_viewport)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		vkCmdSetViewport(m_handle, 0, 1, &p_viewport);
 	}
 
 	void CommandBuffer::SetScissor(const VkRect2D& p_scissor)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		vkCmdSetScissor(m_handle, 0, 1, &p_scissor);
 	}
 
+	void CommandBuffer::SetLineWidth(float p_lineWidth)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetLineWidth(m_handle, p_lineWidth);
+	}
+
+	void CommandBuffer::SetCullMode(VkCullModeFlags p_cullMode)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetCullMode(m_handle, p_cullMode);
+	}
+
+	void CommandBuffer::SetFrontFace(VkFrontFace p_frontFace)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetFrontFace(m_handle, p_frontFace);
+	}
+
+	void CommandBuffer::SetPrimitiveTopology(VkPrimitiveTopology p_topology)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetPrimitiveTopology(m_handle, p_topology);
+	}
+
+	void CommandBuffer::SetDepthTestEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetDepthTestEnable(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetDepthWriteEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetDepthWriteEnable(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetDepthCompareOp(VkCompareOp p_compareOp)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetDepthCompareOp(m_handle, p_compareOp);
+	}
+
+	void CommandBuffer::SetDepthBoundsTestEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetDepthBoundsTestEnable(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetStencilTestEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetStencilTestEnable(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetStencilOp(VkStencilFaceFlags p_faceMask, VkStencilOp p_failOp, VkStencilOp p_passOp, VkStencilOp p_depthFailOp, VkCompareOp p_compareOp)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetStencilOp(m_handle, p_faceMask, p_failOp, p_passOp, p_depthFailOp, p_compareOp);
+	}
+
+	void CommandBuffer::SetRasterizerDiscardEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetRasterizerDiscardEnable(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetDepthBiasEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetDepthBiasEnable(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetPrimitiveRestartEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		vkCmdSetPrimitiveRestartEnable(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetPolygonMode(VkPolygonMode p_polygonMode)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const auto func = m_device.GetDispatch().vkCmdSetPolygonModeEXT;
+
+		assert(func != nullptr && "extended dynamic state 3 isn't supported");
+		func(m_handle, p_polygonMode);
+	}
+
+	void CommandBuffer::SetRasterizationSamples(VkSampleCountFlagBits p_samples)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const auto func = m_device.GetDispatch().vkCmdSetRasterizationSamplesEXT;
+
+		assert(func != nullptr && "extended dynamic state 3 isn't supported");
+		func(m_handle, p_samples);
+	}
+
+	void CommandBuffer::SetDepthClampEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const auto func = m_device.GetDispatch().vkCmdSetDepthClampEnableEXT;
+
+		assert(func != nullptr && "extended dynamic state 3 isn't supported");
+		func(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetLogicOpEnable(bool p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const auto func = m_device.GetDispatch().vkCmdSetLogicOpEnableEXT;
+
+		assert(func != nullptr && "extended dynamic state 3 isn't supported");
+		func(m_handle, p_enabled ? VK_TRUE : VK_FALSE);
+	}
+
+	void CommandBuffer::SetColorBlendEnable(uint32_t p_firstAttachment, std::span<const VkBool32> p_enabled)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const auto func = m_device.GetDispatch().vkCmdSetColorBlendEnableEXT;
+
+		assert(func != nullptr && "extended dynamic state 3 isn't supported");
+		func(m_handle, p_firstAttachment, static_cast<uint32_t>(p_enabled.size()), p_enabled.data());
+	}
+
+	void CommandBuffer::SetColorBlendEquation(uint32_t p_firstAttachment, std::span<const VkColorBlendEquationEXT> p_equations)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const auto func = m_device.GetDispatch().vkCmdSetColorBlendEquationEXT;
+
+		assert(func != nullptr && "extended dynamic state 3 isn't supported");
+		func(m_handle, p_firstAttachment, static_cast<uint32_t>(p_equations.size()), p_equations.data());
+	}
+
+	void CommandBuffer::SetColorWriteMask(uint32_t p_firstAttachment, std::span<const VkColorComponentFlags> p_masks)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const auto func = m_device.GetDispatch().vkCmdSetColorWriteMaskEXT;
+
+		assert(func != nullptr && "extended dynamic state 3 isn't supported");
+		func(m_handle, p_firstAttachment, static_cast<uint32_t>(p_masks.size()), p_masks.data());
+	}
+
 	void CommandBuffer::Draw(uint32_t p_vertexCount, uint32_t p_instanceCount)
 	{
+		VAL_PROFILE_FUNCTION();
+
+		FlushBarriers();
 		vkCmdDraw(m_handle, p_vertexCount, p_instanceCount, 0, 0);
 	}
 
 	void CommandBuffer::DrawIndexed(uint32_t p_indexCount, uint32_t p_instanceCount)
 	{
+		VAL_PROFILE_FUNCTION();
+
+		FlushBarriers();
 		vkCmdDrawIndexed(m_handle, p_indexCount, p_instanceCount, 0, 0, 0);
 	}
+
+	void CommandBuffer::Dispatch(uint32_t p_groupCountX, uint32_t p_groupCountY, uint32_t p_groupCountZ)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(!m_insideRenderPass && "dispatches cannot be recorded inside of a render pass");
+
+		FlushBarriers();
+		vkCmdDispatch(m_handle, p_groupCountX, p_groupCountY, p_groupCountZ);
+	}
 }
@@ -0,0 +1,81 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/CommandBundle.h>
+#include <val/CommandBuffer.h>
+#include <val/CommandPool.h>
+#include <val/RenderPass.h>
+#include <val/utils/CpuProfiler.h>
+#include <algorithm>
+
+namespace val
+{
+	CommandBundle::CommandBundle(CommandPool& p_commandPool, const CommandBundleDesc& p_desc) :
+		m_commandBuffer(p_commandPool.AllocateCommandBuffers(1, VK_COMMAND_BUFFER_LEVEL_SECONDARY).front().get()),
+		m_renderPass(p_desc.renderPass),
+		m_subpass(p_desc.subpass),
+		m_colorAttachmentFormats(p_desc.colorAttachmentFormats.begin(), p_desc.colorAttachmentFormats.end()),
+		m_depthAttachmentFormat(p_desc.depthAttachmentFormat)
+	{
+	}
+
+	bool CommandBundle::Update(std::initializer_list<uint64_t> p_inputs, const RecordCallback& p_record)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		if (m_valid && std::ranges::equal(m_inputs, p_inputs))
+		{
+			return false;
+		}
+
+		// Only used when the bundle is executed within dynamic rendering
+		const VkCommandBufferInheritanceRenderingInfo renderingInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+			.colorAttachmentCount = static_cast<uint32_t>(m_colorAttachmentFormats.size()),
+			.pColorAttachmentFormats = m_colorAttachmentFormats.data(),
+			.depthAttachmentFormat = m_depthAttachmentFormat,
+			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+		};
+
+		const VkCommandBufferInheritanceInfo inheritanceInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+			.pNext = m_renderPass ? nullptr : &renderingInfo,
+			.renderPass = m_renderPass ? m_renderPass->get().GetHandle() : VK_NULL_HANDLE,
+			.subpass = m_subpass
+		};
+
+		m_commandBuffer.Reset();
+
+		// States can't be tracked, since the recorded commands are replayed an arbitrary number of times
+		m_commandBuffer.SetResourceStateTracking(false);
+		m_commandBuffer.Begin(
+			VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
+			inheritanceInfo
+		);
+		p_record(m_commandBuffer);
+		m_commandBuffer.End();
+
+		m_inputs.assign(p_inputs.begin(), p_inputs.end());
+		m_valid = true;
+
+		return true;
+	}
+
+	void CommandBundle::Invalidate()
+	{
+		m_valid = false;
+	}
+
+	bool CommandBundle::IsValid() const
+	{
+		return m_valid;
+	}
+
+	CommandBuffer& CommandBundle::GetCommandBuffer() const
+	{
+		return m_commandBuffer;
+	}
+}
@@ -7,19 +7,23 @@
 #include <val/CommandPool.h>
 #include <val/CommandBuffer.h>
 #include <val/Device.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
 
 namespace val
 {
-	CommandPool::CommandPool(val::Device& p_device) :
-		m_device(p_device)
+	CommandPool::CommandPool(val::Device& p_device, EQueueType p_queueType) :
+		m_device(p_device),
+		m_queueFamilyIndex(p_device.GetQueueFamilyIndex(p_queueType))
 	{
+		VAL_PROFILE_FUNCTION();
+
 		VkCommandPoolCreateInfo createInfo{
 			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
 			.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-			.queueFamilyIndex = m_device.GetQueueFamilyIndices().graphicsFamily.value()
+			.queueFamilyIndex = m_queueFamilyIndex
 		};
 
 		if (vkCreateCommandPool(
@@ -39,6 +43,8 @@ namespace val
 
 	std::vector<std::reference_wrapper<CommandBuffer>> CommandPool::AllocateCommandBuffers(uint32_t p_count, VkCommandBufferLevel p_level)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<std::reference_wrapper<CommandBuffer>> output;
 		output.reserve(p_count);
 
@@ -64,6 +70,7 @@ namespace val
 		{
 			output.emplace_back(
 				m_commandBuffers.emplace_back(CommandBuffer{
+					m_device,
 					allocatedCommandBuffer
 				})
 			);
@@ -76,4 +83,9 @@ namespace val
 	{
 		return m_handle;
 	}
+
+	uint32_t CommandPool::GetQueueFamilyIndex() const
+	{
+		return m_queueFamilyIndex;
+	}
 }
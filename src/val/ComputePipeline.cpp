@@ -0,0 +1,83 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/ComputePipeline.h>
+#include <val/CommandBuffer.h>
+#include <val/Device.h>
+#include <val/utils/MemoryUtils.h>
+#include <val/utils/CpuProfiler.h>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+namespace val
+{
+	ComputePipeline::ComputePipeline(Device& p_device, const ComputePipelineDesc& p_desc) :
+		m_device(p_device.GetLogicalDevice())
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_desc.stage.GetCreateInfo().stage == VK_SHADER_STAGE_COMPUTE_BIT && "a compute pipeline requires a compute shader stage");
+
+		for (const auto& range : p_desc.pushConstantRanges)
+		{
+			assert(range.offset + range.size <= CommandBuffer::k_maxPushConstantsSize && "push constant range exceeds the guaranteed limit");
+		}
+
+		const auto descriptorSetLayouts = utils::MemoryUtils::PrepareArray<VkDescriptorSetLayout>(p_desc.descriptorSetLayouts);
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()),
+			.pSetLayouts = descriptorSetLayouts.data(),
+			.pushConstantRangeCount = static_cast<uint32_t>(p_desc.pushConstantRanges.size()), // Optional
+			.pPushConstantRanges = p_desc.pushConstantRanges.data() // Optional
+		};
+
+		if (vkCreatePipelineLayout(
+			m_device,
+			&pipelineLayoutInfo,
+			nullptr,
+			&m_pipelineLayout
+		) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+
+		// Unlike graphics pipelines, compute pipelines have no fixed-function state: a single stage and a layout
+		VkComputePipelineCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+			.stage = p_desc.stage.GetCreateInfo(),
+			.layout = m_pipelineLayout
+		};
+
+		if (vkCreateComputePipelines(
+			m_device,
+			p_device.GetPipelineCache().GetHandle(),
+			1,
+			&createInfo,
+			nullptr,
+			&m_computePipeline
+		) != VK_SUCCESS) {
+			vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+			throw std::runtime_error("failed to create compute pipeline!");
+		}
+	}
+
+	ComputePipeline::~ComputePipeline()
+	{
+		vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+		vkDestroyPipeline(m_device, m_computePipeline, nullptr);
+	}
+
+	VkPipeline ComputePipeline::GetHandle() const
+	{
+		return m_computePipeline;
+	}
+
+	VkPipelineLayout ComputePipeline::GetLayout() const
+	{
+		return m_pipelineLayout;
+	}
+}
@@ -5,6 +5,7 @@
 */
 
 #include <val/DebugMessenger.h>
+#include <val/utils/CpuProfiler.h>
 #include <stdexcept>
 
 namespace
@@ -138,6 +139,8 @@ namespace val
 	) :
 		m_instance(p_instance)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		if (CreateDebugUtilsMessengerEXT(
 			m_instance,
 			&p_createInfo,
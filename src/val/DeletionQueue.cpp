@@ -0,0 +1,72 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/DeletionQueue.h>
+#include <val/utils/CpuProfiler.h>
+
+namespace val
+{
+	DeletionQueue::~DeletionQueue()
+	{
+		FlushAll();
+	}
+
+	void DeletionQueue::Enqueue(const sync::TimelineValue& p_retireValue, Deleter p_deleter)
+	{
+		std::scoped_lock lock(m_mutex);
+
+		m_pendingDeletions.push_back({
+			.retireValue = p_retireValue,
+			.deleter = std::move(p_deleter)
+		});
+	}
+
+	void DeletionQueue::Flush()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::vector<Deleter> retiredDeleters;
+
+		{
+			std::scoped_lock lock(m_mutex);
+
+			sync::TimelineValueChecker checker;
+
+			std::erase_if(m_pendingDeletions, [&](PendingDeletion& p_deletion) {
+				if (checker.IsReached(p_deletion.retireValue))
+				{
+					retiredDeleters.push_back(std::move(p_deletion.deleter));
+					return true;
+				}
+
+				return false;
+			});
+		}
+
+		// Deleters are executed outside of the lock, since they may enqueue other deletions
+		for (auto& deleter : retiredDeleters)
+		{
+			deleter();
+		}
+	}
+
+	void DeletionQueue::FlushAll()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::vector<PendingDeletion> pendingDeletions;
+
+		{
+			std::scoped_lock lock(m_mutex);
+			pendingDeletions.swap(m_pendingDeletions);
+		}
+
+		for (auto& deletion : pendingDeletions)
+		{
+			deletion.deleter();
+		}
+	}
+}
@@ -8,6 +8,7 @@
 #include <val/DescriptorSet.h>
 #include <val/DescriptorSetLayout.h>
 #include <val/Device.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -17,6 +18,8 @@ namespace val
 	DescriptorPool::DescriptorPool(val::Device& p_device, uint32_t p_maxSetCount) :
 		m_device(p_device)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		assert(p_maxSetCount > 0 && "Max set count must be greater than 0");
 
 		VkDescriptorPoolSize poolSize{
@@ -52,6 +55,8 @@ namespace val
 		uint32_t p_count
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<VkDescriptorSetLayout> layouts(p_count, p_layout.GetHandle());
 
 		std::vector<std::reference_wrapper<DescriptorSet>> output;
@@ -7,6 +7,7 @@
 #include <val/DescriptorSet.h>
 #include <val/Buffer.h>
 #include <val/utils/MemoryUtils.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -29,6 +30,8 @@ namespace val
 		std::span<const std::reference_wrapper<Buffer>> p_buffers
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<VkDescriptorBufferInfo> bufferInfos;
 		bufferInfos.reserve(p_buffers.size());
 
@@ -5,6 +5,7 @@
 */
 
 #include <val/DescriptorSetLayout.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -14,6 +15,8 @@ namespace val
 	DescriptorSetLayout::DescriptorSetLayout(VkDevice p_device, std::span<const DescriptorSetLayoutBinding> p_bindings) :
 		m_device(p_device)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<VkDescriptorSetLayoutBinding> bindings;
 		bindings.reserve(p_bindings.size());
 
@@ -6,6 +6,7 @@
 
 #include <val/utils/ValidationLayerManager.h>
 #include <val/Device.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <optional>
@@ -13,9 +14,23 @@
 #include <set>
 #include <limits>
 #include <algorithm> 
+#include <chrono>
+#include <thread>
 
 namespace
 {
+	template<typename T>
+	void LoadDeviceFunction(VkDevice p_device, T& p_function, const char* p_name)
+	{
+		p_function = reinterpret_cast<T>(vkGetDeviceProcAddr(p_device, p_name));
+
+		// The extension has been enabled, so the driver must expose all of its functions
+		if (p_function == nullptr)
+		{
+			throw std::runtime_error(std::string("failed to load device function ") + p_name + "!");
+		}
+	}
+
 	val::QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device, VkSurfaceKHR p_surface)
 	{
 		val::QueueFamilyIndices indices;
@@ -28,32 +43,100 @@ namespace
 
 		uint32_t i = 0;
 
+		// Families supporting transfers without graphics, preferably without compute either (dedicated DMA engines)
+		std::optional<uint32_t> dedicatedTransferFamily;
+		std::optional<uint32_t> nonGraphicsTransferFamily;
+
 		for (const auto& queueFamily : queueFamilies)
 		{
-			// Early exit if all family queues have been identified
-			if (indices.IsComplete())
+			if (!indices.graphicsFamily.has_value() && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
 			{
-				break;
+				indices.graphicsFamily = i;
 			}
 
-			if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+			if (!indices.presentFamily.has_value())
 			{
-				indices.graphicsFamily = i;
+				VkBool32 presentSupport = false;
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, p_surface, &presentSupport);
+				if (presentSupport)
+				{
+					indices.presentFamily = i;
+				}
 			}
 
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, p_surface, &presentSupport);
-			if (presentSupport)
+			// Async compute: a family supporting compute without graphics, so compute work can overlap with rasterization
+			if (!indices.computeFamily.has_value() && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
 			{
-				indices.presentFamily = i;
+				indices.computeFamily = i;
+			}
+
+			if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT))
+			{
+				if (!(queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && !dedicatedTransferFamily.has_value())
+				{
+					dedicatedTransferFamily = i;
+				}
+				else if (!nonGraphicsTransferFamily.has_value())
+				{
+					nonGraphicsTransferFamily = i;
+				}
 			}
 
 			++i;
 		}
 
+		indices.transferFamily = dedicatedTransferFamily.has_value() ? dedicatedTransferFamily : nonGraphicsTransferFamily;
+
 		return indices;
 	}
 
+	// Polls for the given wait budget, then falls back to a blocking wait with the remaining timeout
+	template<class PollFunc, class BlockFunc>
+	bool HybridWait(
+		const val::sync::WaitStrategy& p_strategy,
+		val::sync::WaitHistogram& p_histogram,
+		std::optional<uint64_t> p_timeout,
+		PollFunc p_poll,
+		BlockFunc p_block
+	)
+	{
+		using namespace std::chrono;
+
+		const auto start = steady_clock::now();
+		const uint64_t timeout = p_timeout.value_or(std::numeric_limits<uint64_t>::max());
+		const uint64_t spinBudget = std::min(p_strategy.spinBudgetNs, timeout);
+
+		auto elapsedNs = [&] {
+			return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+		};
+
+		if (spinBudget > 0)
+		{
+			do
+			{
+				if (p_poll())
+				{
+					p_histogram.Record(elapsedNs(), false);
+					return true;
+				}
+
+				if (p_strategy.yieldWhileSpinning)
+				{
+					std::this_thread::yield();
+				}
+			} while (elapsedNs() < spinBudget);
+		}
+
+		const uint64_t elapsed = elapsedNs();
+		const uint64_t remainingTimeout =
+			timeout == std::numeric_limits<uint64_t>::max() ? timeout :
+			timeout > elapsed ? timeout - elapsed : 0;
+
+		const bool signaled = p_block(remainingTimeout);
+		p_histogram.Record(elapsedNs(), true);
+		return signaled;
+	}
+
 	bool IsSwapChainAdequate(const val::utils::SwapChainSupportDetails& p_swapChainSupportDetails)
 	{
 		return
@@ -69,6 +152,18 @@ namespace val
 		return graphicsFamily.has_value() && presentFamily.has_value();
 	}
 
+	std::vector<uint32_t> QueueFamilyIndices::GetPresentationQueueIndices() const
+	{
+		assert(IsComplete());
+
+		if (graphicsFamily.value() == presentFamily.value())
+		{
+			return { graphicsFamily.value() };
+		}
+
+		return { graphicsFamily.value(), presentFamily.value() };
+	}
+
 	std::vector<uint32_t> QueueFamilyIndices::GetUniqueQueueIndices() const
 	{
 		assert(IsComplete());
@@ -78,6 +173,16 @@ namespace val
 			presentFamily.value()
 		};
 
+		if (computeFamily.has_value())
+		{
+			uniqueIndices.insert(computeFamily.value());
+		}
+
+		if (transferFamily.has_value())
+		{
+			uniqueIndices.insert(transferFamily.value());
+		}
+
 		std::vector<uint32_t> output;
 		output.reserve(uniqueIndices.size());
 
@@ -94,13 +199,92 @@ namespace val
 		m_queueFamilyIndices(FindQueueFamilies(p_physicalDevice, p_surface)),
 		m_surface(p_surface)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		vkGetPhysicalDeviceProperties(m_physicalDevice, &m_physicalDeviceProperties);
-		vkGetPhysicalDeviceFeatures(m_physicalDevice, &m_physicalDeviceFeatures);
 
 		m_extensionManager.FetchExtensions<utils::EExtensionHandler::PhysicalDevice>(m_physicalDevice);
 
+		m_physicalDeviceVulkan12Features = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+		m_physicalDeviceVulkan13Features = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
+		m_physicalDeviceConditionalRenderingFeatures = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONDITIONAL_RENDERING_FEATURES_EXT };
+		m_physicalDeviceGraphicsPipelineLibraryFeatures = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT };
+		m_physicalDeviceExtendedDynamicState3Features = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT };
+		m_physicalDeviceSwapchainMaintenance1Features = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT };
+
+		// Swap chain maintenance depends on surface maintenance, which the instance enables whenever it is available
+		utils::ExtensionManager instanceExtensionManager;
+		instanceExtensionManager.FetchExtensions<utils::EExtensionHandler::Instance>();
+		const bool swapchainMaintenance1Available =
+			instanceExtensionManager.IsExtensionSupported(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME) &&
+			m_extensionManager.IsExtensionSupported(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+
+		// Vulkan 1.2 and 1.3 features (synchronization2, etc.) can only be queried on devices supporting Vulkan 1.3
+		if (m_physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3)
+		{
+			m_physicalDeviceVulkan12Features.pNext = &m_physicalDeviceVulkan13Features;
+
+			// Extension features can only be queried if the extension is supported
+			void** next = &m_physicalDeviceVulkan13Features.pNext;
+
+			if (m_extensionManager.IsExtensionSupported(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME))
+			{
+				*next = &m_physicalDeviceConditionalRenderingFeatures;
+				next = &m_physicalDeviceConditionalRenderingFeatures.pNext;
+			}
+
+			if (m_extensionManager.IsExtensionSupported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+			{
+				*next = &m_physicalDeviceGraphicsPipelineLibraryFeatures;
+				next = &m_physicalDeviceGraphicsPipelineLibraryFeatures.pNext;
+			}
+
+			if (m_extensionManager.IsExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+			{
+				*next = &m_physicalDeviceExtendedDynamicState3Features;
+				next = &m_physicalDeviceExtendedDynamicState3Features.pNext;
+			}
+
+			if (swapchainMaintenance1Available)
+			{
+				*next = &m_physicalDeviceSwapchainMaintenance1Features;
+				next = &m_physicalDeviceSwapchainMaintenance1Features.pNext;
+			}
+
+			VkPhysicalDeviceFeatures2 features{
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &m_physicalDeviceVulkan12Features
+			};
+
+			vkGetPhysicalDeviceFeatures2(m_physicalDevice, &features);
+			m_physicalDeviceFeatures = features.features;
+
+			// The feature chain is rebuilt when creating the logical device
+			m_physicalDeviceVulkan12Features.pNext = nullptr;
+			m_physicalDeviceVulkan13Features.pNext = nullptr;
+			m_physicalDeviceConditionalRenderingFeatures.pNext = nullptr;
+			m_physicalDeviceGraphicsPipelineLibraryFeatures.pNext = nullptr;
+			m_physicalDeviceExtendedDynamicState3Features.pNext = nullptr;
+			m_physicalDeviceSwapchainMaintenance1Features.pNext = nullptr;
+		}
+		else
+		{
+			vkGetPhysicalDeviceFeatures(m_physicalDevice, &m_physicalDeviceFeatures);
+		}
+
 		// Based on the configuration of the device, we require some extensions.
 		m_requestedExtensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME, true);
+
+		// Optional extensions, only enabled if supported
+		m_requestedExtensions.emplace_back(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME, false);
+		m_requestedExtensions.emplace_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, false);
+		m_requestedExtensions.emplace_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, false);
+		m_requestedExtensions.emplace_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME, false);
+
+		if (swapchainMaintenance1Available)
+		{
+			m_requestedExtensions.emplace_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME, false);
+		}
 	}
 
 	Device::Device(const Device& p_rhs)
@@ -112,17 +296,51 @@ namespace val
 
 	Device::~Device()
 	{
+		// Deferred deletions can only be executed once the GPU is done with them
+		if (m_logicalDevice != VK_NULL_HANDLE)
+		{
+			vkDeviceWaitIdle(m_logicalDevice);
+		}
+
+		m_deletionQueue.reset();
+
+		// The reactor may be waiting for queue timelines, so it is stopped before queues are destroyed
+		m_reactor.reset();
+		m_queues.clear();
+
+		// Pooled sync objects must be destroyed before their logical device
+		m_fencePool.reset();
+		m_semaphorePool.reset();
+
+		// Saved to disk on destruction
+		m_pipelineCache.reset();
+
 		vkDestroyDevice(m_logicalDevice, nullptr);
 	}
 
 	void Device::QuerySuitability()
 	{
+		VAL_PROFILE_FUNCTION();
+
 		m_suitable = [this]() {
 			if (!m_queueFamilyIndices.IsComplete())
 			{
 				return false;
 			}
 
+			// Automatic barriers rely on vkCmdPipelineBarrier2 (synchronization2), and rendering without render pass objects
+			// relies on vkCmdBeginRendering (dynamicRendering), both core in Vulkan 1.3.
+			// Query pools are reset from the host (hostQueryReset), and frames are synchronized using
+			// timeline semaphores (timelineSemaphore), both core in Vulkan 1.2.
+			if (m_physicalDeviceProperties.apiVersion < VK_API_VERSION_1_3 ||
+				!m_physicalDeviceVulkan13Features.synchronization2 ||
+				!m_physicalDeviceVulkan13Features.dynamicRendering ||
+				!m_physicalDeviceVulkan12Features.hostQueryReset ||
+				!m_physicalDeviceVulkan12Features.timelineSemaphore)
+			{
+				return false;
+			}
+
 			// A device isn't suitable if any of the required extension is unavailable
 			for (auto& extension : m_requestedExtensions)
 			{
@@ -147,6 +365,8 @@ namespace val
 
 	void Device::QuerySwapChainDetails()
 	{
+		VAL_PROFILE_FUNCTION();
+
 		m_swapChainSupportDetails = utils::SwapChainUtils::QuerySwapChainDetails(m_physicalDevice, m_surface);
 	}
 
@@ -155,24 +375,41 @@ namespace val
 		return m_suitable;
 	}
 
-	void Device::CreateLogicalDevice(std::vector<const char*> p_validationLayers)
+	void Device::CreateLogicalDevice(
+		std::vector<const char*> p_validationLayers,
+		std::optional<std::filesystem::path> p_pipelineCachePath
+	)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 
-		std::set<uint32_t> uniqueQueueFamilies = {
-			m_queueFamilyIndices.graphicsFamily.value(),
-			m_queueFamilyIndices.presentFamily.value()
-		};
+		const std::vector<uint32_t> uniqueQueueFamilies = m_queueFamilyIndices.GetUniqueQueueIndices();
+
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, nullptr);
 
-		float queuePriority = 1.0f;
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+		// When compute and transfer resolve to the same family, they get distinct queues (if the family exposes
+		// enough of them), so uploads don't get serialized behind compute work.
+		const uint32_t computeFamily = GetQueueFamilyIndex(EQueueType::Compute);
+		const uint32_t transferFamily = GetQueueFamilyIndex(EQueueType::Transfer);
+		const uint32_t transferQueueIndex =
+			transferFamily == computeFamily &&
+			transferFamily != m_queueFamilyIndices.graphicsFamily.value() &&
+			queueFamilies[transferFamily].queueCount > 1 ? 1 : 0;
+
+		const std::array<float, 2> queuePriorities = { 1.0f, 1.0f };
 
 		for (uint32_t queueFamily : uniqueQueueFamilies)
 		{
 			VkDeviceQueueCreateInfo queueCreateInfo{
 				.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
 				.queueFamilyIndex = queueFamily,
-				.queueCount = 1,
-				.pQueuePriorities = &queuePriority
+				.queueCount = queueFamily == transferFamily ? transferQueueIndex + 1 : 1,
+				.pQueuePriorities = queuePriorities.data()
 			};
 
 			queueCreateInfos.push_back(queueCreateInfo);
@@ -182,8 +419,51 @@ namespace val
 		// since we checked for them in "IsSuitable()"
 		std::vector<const char*> extensions = m_extensionManager.FilterExtensions(m_requestedExtensions);
 
+		// Enable every supported feature. Since Vulkan 1.2 and 1.3 features are provided through
+		// the pNext chain, core features must be provided using VkPhysicalDeviceFeatures2 as well.
+		VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT swapchainMaintenance1Features = m_physicalDeviceSwapchainMaintenance1Features;
+		VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extendedDynamicState3Features = m_physicalDeviceExtendedDynamicState3Features;
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures = m_physicalDeviceGraphicsPipelineLibraryFeatures;
+		VkPhysicalDeviceConditionalRenderingFeaturesEXT conditionalRenderingFeatures = m_physicalDeviceConditionalRenderingFeatures;
+		VkPhysicalDeviceVulkan13Features vulkan13Features = m_physicalDeviceVulkan13Features;
+		VkPhysicalDeviceVulkan12Features vulkan12Features = m_physicalDeviceVulkan12Features;
+		vulkan12Features.pNext = &vulkan13Features;
+
+		void** next = &vulkan13Features.pNext;
+
+		if (IsConditionalRenderingSupported())
+		{
+			*next = &conditionalRenderingFeatures;
+			next = &conditionalRenderingFeatures.pNext;
+		}
+
+		if (IsGraphicsPipelineLibrarySupported())
+		{
+			*next = &graphicsPipelineLibraryFeatures;
+			next = &graphicsPipelineLibraryFeatures.pNext;
+		}
+
+		if (IsExtendedDynamicState3Supported())
+		{
+			*next = &extendedDynamicState3Features;
+			next = &extendedDynamicState3Features.pNext;
+		}
+
+		if (IsSwapchainMaintenance1Supported())
+		{
+			*next = &swapchainMaintenance1Features;
+			next = &swapchainMaintenance1Features.pNext;
+		}
+
+		VkPhysicalDeviceFeatures2 features{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = &vulkan12Features,
+			.features = m_physicalDeviceFeatures
+		};
+
 		VkDeviceCreateInfo createInfo{
 			.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+			.pNext = &features,
 			.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
 			.pQueueCreateInfos = queueCreateInfos.data(),
 			// Deprecated validation layers on device
@@ -191,7 +471,7 @@ namespace val
 			// .ppEnabledLayerNames = p_validationLayers.data(),
 			.enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
 			.ppEnabledExtensionNames = extensions.data(),
-			.pEnabledFeatures = &m_physicalDeviceFeatures,
+			.pEnabledFeatures = nullptr, // Provided by VkPhysicalDeviceFeatures2
 		};
 
 		if (vkCreateDevice(
@@ -204,19 +484,57 @@ namespace val
 			throw std::runtime_error("failed to create logical device!");
 		}
 
-		VkQueue graphicsQueue, presentQueue;
-		vkGetDeviceQueue(m_logicalDevice, m_queueFamilyIndices.graphicsFamily.value(), 0, &graphicsQueue);
-		vkGetDeviceQueue(m_logicalDevice, m_queueFamilyIndices.presentFamily.value(), 0, &presentQueue);
+		LoadDispatch();
 
-		m_graphicsQueue = std::unique_ptr<Queue>(new Queue(
-			m_logicalDevice,
-			graphicsQueue
-		));
+		// Resumes coroutines awaiting submissions, so it must be created before the queues
+		m_reactor = std::make_unique<GpuReactor>(m_logicalDevice);
 
-		m_presentQueue = std::unique_ptr<Queue>(new Queue(
-			m_logicalDevice,
-			presentQueue
-		));
+		// Queue types resolving to the same VkQueue share the same Queue instance: a VkQueue requires external
+		// synchronization, and a Queue owns the timeline tracking its submissions.
+		auto getQueue = [this](uint32_t p_family, uint32_t p_index) {
+			VkQueue handle;
+			vkGetDeviceQueue(m_logicalDevice, p_family, p_index, &handle);
+
+			for (const auto& queue : m_queues)
+			{
+				if (queue->GetHandle() == handle)
+				{
+					return queue.get();
+				}
+			}
+
+			return m_queues.emplace_back(new Queue(m_logicalDevice, handle, *m_reactor)).get();
+		};
+
+		m_graphicsQueue = getQueue(m_queueFamilyIndices.graphicsFamily.value(), 0);
+		m_presentQueue = getQueue(m_queueFamilyIndices.presentFamily.value(), 0);
+		m_computeQueue = getQueue(computeFamily, 0);
+		m_transferQueue = getQueue(transferFamily, transferQueueIndex);
+
+		m_fencePool = std::make_unique<sync::FencePool>(m_logicalDevice);
+		m_semaphorePool = std::make_unique<sync::SemaphorePool>(m_logicalDevice);
+		m_deletionQueue = std::make_unique<DeletionQueue>();
+		m_pipelineCache = std::make_unique<PipelineCache>(*this, std::move(p_pipelineCachePath));
+	}
+
+	void Device::LoadDispatch()
+	{
+		if (IsConditionalRenderingSupported())
+		{
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdBeginConditionalRenderingEXT, "vkCmdBeginConditionalRenderingEXT");
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdEndConditionalRenderingEXT, "vkCmdEndConditionalRenderingEXT");
+		}
+
+		if (IsExtendedDynamicState3Supported())
+		{
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdSetPolygonModeEXT, "vkCmdSetPolygonModeEXT");
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdSetRasterizationSamplesEXT, "vkCmdSetRasterizationSamplesEXT");
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdSetDepthClampEnableEXT, "vkCmdSetDepthClampEnableEXT");
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdSetLogicOpEnableEXT, "vkCmdSetLogicOpEnableEXT");
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdSetColorBlendEnableEXT, "vkCmdSetColorBlendEnableEXT");
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdSetColorBlendEquationEXT, "vkCmdSetColorBlendEquationEXT");
+			LoadDeviceFunction(m_logicalDevice, m_dispatch.vkCmdSetColorWriteMaskEXT, "vkCmdSetColorWriteMaskEXT");
+		}
 	}
 
 	VkPhysicalDevice Device::GetPhysicalDevice() const
@@ -232,7 +550,14 @@ namespace val
 		return m_logicalDevice;
 	}
 
-	Queue Device::GetGraphicsQueue() const
+	const DeviceDispatch& Device::GetDispatch() const
+	{
+		assert(m_suitable);
+		assert(m_logicalDevice != VK_NULL_HANDLE);
+		return m_dispatch;
+	}
+
+	Queue& Device::GetGraphicsQueue() const
 	{
 		assert(m_suitable);
 		assert(m_logicalDevice != VK_NULL_HANDLE);
@@ -240,7 +565,7 @@ namespace val
 		return *m_graphicsQueue;
 	}
 
-	Queue Device::GetPresentQueue() const
+	Queue& Device::GetPresentQueue() const
 	{
 		assert(m_suitable);
 		assert(m_logicalDevice != VK_NULL_HANDLE);
@@ -248,6 +573,115 @@ namespace val
 		return *m_presentQueue;
 	}
 
+	Queue& Device::GetComputeQueue() const
+	{
+		assert(m_suitable);
+		assert(m_logicalDevice != VK_NULL_HANDLE);
+		assert(m_computeQueue);
+		return *m_computeQueue;
+	}
+
+	Queue& Device::GetTransferQueue() const
+	{
+		assert(m_suitable);
+		assert(m_logicalDevice != VK_NULL_HANDLE);
+		assert(m_transferQueue);
+		return *m_transferQueue;
+	}
+
+	sync::FencePool& Device::GetFencePool() const
+	{
+		assert(m_logicalDevice != VK_NULL_HANDLE);
+		assert(m_fencePool);
+		return *m_fencePool;
+	}
+
+	sync::SemaphorePool& Device::GetSemaphorePool() const
+	{
+		assert(m_logicalDevice != VK_NULL_HANDLE);
+		assert(m_semaphorePool);
+		return *m_semaphorePool;
+	}
+
+	GpuReactor& Device::GetReactor() const
+	{
+		assert(m_logicalDevice != VK_NULL_HANDLE);
+		assert(m_reactor);
+		return *m_reactor;
+	}
+
+	DeletionQueue& Device::GetDeletionQueue() const
+	{
+		assert(m_logicalDevice != VK_NULL_HANDLE);
+		assert(m_deletionQueue);
+		return *m_deletionQueue;
+	}
+
+	PipelineCache& Device::GetPipelineCache() const
+	{
+		assert(m_logicalDevice != VK_NULL_HANDLE);
+		assert(m_pipelineCache);
+		return *m_pipelineCache;
+	}
+
+	uint32_t Device::GetQueueFamilyIndex(EQueueType p_queueType) const
+	{
+		switch (p_queueType)
+		{
+		case EQueueType::Compute: return m_queueFamilyIndices.computeFamily.value_or(m_queueFamilyIndices.graphicsFamily.value());
+		case EQueueType::Transfer: return m_queueFamilyIndices.transferFamily.value_or(m_queueFamilyIndices.graphicsFamily.value());
+		default: return m_queueFamilyIndices.graphicsFamily.value();
+		}
+	}
+
+	bool Device::HasDedicatedComputeQueue() const
+	{
+		return m_queueFamilyIndices.computeFamily.has_value();
+	}
+
+	bool Device::HasDedicatedTransferQueue() const
+	{
+		return m_queueFamilyIndices.transferFamily.has_value();
+	}
+
+	const VkPhysicalDeviceProperties& Device::GetProperties() const
+	{
+		return m_physicalDeviceProperties;
+	}
+
+	bool Device::IsConditionalRenderingSupported() const
+	{
+		return
+			m_extensionManager.IsExtensionSupported(VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME) &&
+			m_physicalDeviceConditionalRenderingFeatures.conditionalRendering;
+	}
+
+	bool Device::IsGraphicsPipelineLibrarySupported() const
+	{
+		return
+			m_extensionManager.IsExtensionSupported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+			m_extensionManager.IsExtensionSupported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+			m_physicalDeviceGraphicsPipelineLibraryFeatures.graphicsPipelineLibrary;
+	}
+
+	bool Device::IsExtendedDynamicState3Supported() const
+	{
+		return m_extensionManager.IsExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+	}
+
+	bool Device::IsSwapchainMaintenance1Supported() const
+	{
+		// Only queried (and thus true) if the instance supports surface maintenance as well
+		return
+			m_extensionManager.IsExtensionSupported(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME) &&
+			m_physicalDeviceSwapchainMaintenance1Features.swapchainMaintenance1;
+	}
+
+	const VkPhysicalDeviceExtendedDynamicState3FeaturesEXT& Device::GetExtendedDynamicState3Features() const
+	{
+		return m_physicalDeviceExtendedDynamicState3Features;
+	}
+
 	const utils::SwapChainSupportDetails& Device::GetSwapChainSupportDetails() const
 	{
 		assert(m_suitable);
@@ -259,12 +693,14 @@ namespace val
 		return m_queueFamilyIndices;
 	}
 
-	void Device::WaitForFences(
+	bool Device::WaitForFences(
 		std::initializer_list<std::reference_wrapper<val::sync::Fence>> p_fences,
 		bool p_waitAll,
 		std::optional<uint64_t> p_timeout
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<VkFence> fences;
 		fences.reserve(p_fences.size());
 		for (const auto& fence : p_fences)
@@ -272,19 +708,37 @@ namespace val
 			fences.push_back(fence.get().GetHandle());
 		}
 
-		vkWaitForFences(
-			m_logicalDevice,
-			static_cast<uint32_t>(fences.size()),
-			fences.data(),
-			p_waitAll,
-			p_timeout.value_or(std::numeric_limits<uint64_t>::max())
-		);
+		auto poll = [&] {
+			auto isSignaled = [&](VkFence p_fence) { return vkGetFenceStatus(m_logicalDevice, p_fence) == VK_SUCCESS; };
+			return p_waitAll ? std::ranges::all_of(fences, isSignaled) : std::ranges::any_of(fences, isSignaled);
+		};
+
+		auto block = [&](uint64_t p_remainingTimeout) {
+			const VkResult result = vkWaitForFences(
+				m_logicalDevice,
+				static_cast<uint32_t>(fences.size()),
+				fences.data(),
+				p_waitAll,
+				p_remainingTimeout
+			);
+
+			if (result != VK_SUCCESS && result != VK_TIMEOUT)
+			{
+				throw std::runtime_error("failed to wait for fences!");
+			}
+
+			return result == VK_SUCCESS;
+		};
+
+		return HybridWait(m_waitStrategy, m_waitHistogram, p_timeout, poll, block);
 	}
 
 	void Device::ResetFences(
 		std::initializer_list<std::reference_wrapper<val::sync::Fence>> p_fences
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<VkFence> fences;
 		fences.reserve(p_fences.size());
 		for (const auto& fence : p_fences)
@@ -298,34 +752,70 @@ namespace val
 			fences.data()
 		);
 	}
-	void Device::WaitForSemaphores(
-		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_semaphores,
+	bool Device::WaitForSemaphores(
+		std::initializer_list<sync::TimelineValue> p_values,
 		bool p_waitAll,
 		std::optional<uint64_t> p_timeout
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<VkSemaphore> semaphores;
-		semaphores.reserve(p_semaphores.size());
-		for (const auto& semaphore : p_semaphores)
+		std::vector<uint64_t> values;
+		semaphores.reserve(p_values.size());
+		values.reserve(p_values.size());
+		for (const auto& value : p_values)
 		{
-			semaphores.push_back(semaphore.get().GetHandle());
+			semaphores.push_back(value.semaphore.get().GetHandle());
+			values.push_back(value.value);
 		}
 
-		VkSemaphoreWaitInfo waitInfo{
-			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
-			.semaphoreCount = static_cast<uint32_t>(semaphores.size()),
-			.pSemaphores = semaphores.data()
+		auto poll = [&] {
+			auto isReached = [&](const sync::TimelineValue& p_value) { return p_value.semaphore.get().GetValue() >= p_value.value; };
+			return p_waitAll ? std::ranges::all_of(p_values, isReached) : std::ranges::any_of(p_values, isReached);
 		};
 
-		vkWaitSemaphores(
-			m_logicalDevice,
-			&waitInfo,
-			p_timeout.value_or(std::numeric_limits<uint64_t>::max())
-		);
+		auto block = [&](uint64_t p_remainingTimeout) {
+			VkSemaphoreWaitInfo waitInfo{
+				.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+				.flags = p_waitAll ? 0U : VK_SEMAPHORE_WAIT_ANY_BIT,
+				.semaphoreCount = static_cast<uint32_t>(semaphores.size()),
+				.pSemaphores = semaphores.data(),
+				.pValues = values.data()
+			};
+
+			const VkResult result = vkWaitSemaphores(m_logicalDevice, &waitInfo, p_remainingTimeout);
+
+			if (result != VK_SUCCESS && result != VK_TIMEOUT)
+			{
+				throw std::runtime_error("failed to wait for semaphores!");
+			}
+
+			return result == VK_SUCCESS;
+		};
+
+		return HybridWait(m_waitStrategy, m_waitHistogram, p_timeout, poll, block);
+	}
+
+	void Device::SetWaitStrategy(const sync::WaitStrategy& p_strategy)
+	{
+		m_waitStrategy = p_strategy;
+	}
+
+	const sync::WaitStrategy& Device::GetWaitStrategy() const
+	{
+		return m_waitStrategy;
+	}
+
+	sync::WaitHistogram& Device::GetWaitHistogram()
+	{
+		return m_waitHistogram;
 	}
 
 	void Device::WaitIdle()
 	{
+		VAL_PROFILE_FUNCTION();
+
 		vkDeviceWaitIdle(m_logicalDevice);
 	}
 }
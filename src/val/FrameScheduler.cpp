@@ -0,0 +1,280 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/FrameScheduler.h>
+#include <val/Device.h>
+#include <val/SwapChain.h>
+#include <val/Image.h>
+#include <val/utils/CpuProfiler.h>
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+namespace
+{
+	// Weight of the latest frame in the averaged wait times
+	constexpr double k_averageWeight = 0.05;
+
+	double ElapsedMs(std::chrono::steady_clock::time_point p_start, std::chrono::steady_clock::time_point p_end)
+	{
+		return std::chrono::duration<double, std::milli>(p_end - p_start).count();
+	}
+
+	bool AreSignaled(VkDevice p_device, std::span<val::sync::Fence* const> p_fences, bool p_wait)
+	{
+		if (p_fences.empty())
+		{
+			return true;
+		}
+
+		std::vector<VkFence> handles;
+		handles.reserve(p_fences.size());
+
+		for (auto fence : p_fences)
+		{
+			handles.push_back(fence->GetHandle());
+		}
+
+		const VkResult result = vkWaitForFences(
+			p_device,
+			static_cast<uint32_t>(handles.size()),
+			handles.data(),
+			VK_TRUE,
+			p_wait ? std::numeric_limits<uint64_t>::max() : 0
+		);
+
+		if (result != VK_SUCCESS && result != VK_TIMEOUT)
+		{
+			throw std::runtime_error("failed to wait for present fences!");
+		}
+
+		return result == VK_SUCCESS;
+	}
+}
+
+namespace val
+{
+	FrameScheduler::FrameScheduler(Device& p_device, SwapChain& p_swapChain, const FrameSchedulerDesc& p_desc) :
+		m_device(p_device),
+		m_swapChain(&p_swapChain),
+		m_framesInFlight(p_desc.framesInFlight),
+		m_timeline(p_device.GetLogicalDevice()),
+		m_usePresentFences(p_device.IsSwapchainMaintenance1Supported())
+	{
+		assert(m_framesInFlight > 0 && "at least one frame must be in flight");
+
+		m_imageAvailableSemaphores.reserve(m_framesInFlight);
+		for (uint32_t i = 0; i < m_framesInFlight; ++i)
+		{
+			m_imageAvailableSemaphores.push_back(&m_device.GetSemaphorePool().Acquire());
+		}
+
+		SetSwapChain(p_swapChain);
+	}
+
+	FrameScheduler::~FrameScheduler()
+	{
+		m_timeline.Wait(m_frameNumber);
+
+		// Deletions keyed on this timeline must not outlive it
+		m_device.GetDeletionQueue().Flush();
+
+		for (auto semaphore : m_imageAvailableSemaphores)
+		{
+			m_device.GetSemaphorePool().Release(*semaphore);
+		}
+
+		// The current swap chain is owned by the caller, only its present semaphores are released
+		RetireSwapChain(nullptr);
+		ReleaseRetiredSwapChains(true);
+	}
+
+	const FrameContext& FrameScheduler::BeginFrame()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(!m_currentFrame.has_value() && "the previous frame must be ended before beginning a new one");
+
+		const uint32_t frameIndex = static_cast<uint32_t>(m_frameNumber % m_framesInFlight);
+
+		const auto waitStart = std::chrono::steady_clock::now();
+
+		// Wait for the previous frame using the same slot (m_framesInFlight frames ago) to complete.
+		// The device wait strategy applies, so latency-sensitive applications can spin instead of blocking.
+		if (m_frameNumber >= m_framesInFlight)
+		{
+			m_device.WaitForSemaphores({ { m_timeline, m_frameNumber - m_framesInFlight + 1 } });
+		}
+
+		// Resources released by completed frames can now be destroyed
+		m_device.GetDeletionQueue().Flush();
+
+		// Same goes for completed presentations
+		RecyclePresentFences();
+		ReleaseRetiredSwapChains(false);
+
+		const auto acquireStart = std::chrono::steady_clock::now();
+
+		sync::Semaphore& imageAvailableSemaphore = *m_imageAvailableSemaphores[frameIndex];
+		const uint32_t swapImageIndex = m_swapChain->AcquireNextImage(imageAvailableSemaphore);
+
+		const auto acquireEnd = std::chrono::steady_clock::now();
+
+		m_lastWaitTimes = {
+			.frameSlotMs = ElapsedMs(waitStart, acquireStart),
+			.acquireMs = ElapsedMs(acquireStart, acquireEnd)
+		};
+
+		m_averageWaitTimes = {
+			.frameSlotMs = m_averageWaitTimes.frameSlotMs + (m_lastWaitTimes.frameSlotMs - m_averageWaitTimes.frameSlotMs) * k_averageWeight,
+			.acquireMs = m_averageWaitTimes.acquireMs + (m_lastWaitTimes.acquireMs - m_averageWaitTimes.acquireMs) * k_averageWeight
+		};
+
+		return m_currentFrame.emplace(FrameContext{
+			.frameIndex = frameIndex,
+			.frameNumber = m_frameNumber,
+			.swapImageIndex = swapImageIndex,
+			.swapChainImage = m_swapChain->GetImage(swapImageIndex),
+			.swapChainImageView = m_swapChain->GetImageViews()[swapImageIndex],
+			.imageAvailableSemaphore = imageAvailableSemaphore,
+			.renderFinishedSemaphore = *m_renderFinishedSemaphores[swapImageIndex],
+			.completionValue = { m_timeline, m_frameNumber + 1 }
+		});
+	}
+
+	void FrameScheduler::EndFrame()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(m_currentFrame.has_value() && "a frame must be begun before being ended");
+
+		sync::Semaphore& renderFinishedSemaphore = m_currentFrame->renderFinishedSemaphore;
+		const uint32_t swapImageIndex = m_currentFrame->swapImageIndex;
+
+		// The frame ends even if the presentation fails, since it has been submitted already
+		m_currentFrame.reset();
+		++m_frameNumber;
+
+		std::optional<std::reference_wrapper<sync::Fence>> presentFence;
+
+		if (m_usePresentFences)
+		{
+			presentFence = *m_presentFences.emplace_back(&m_device.GetFencePool().Acquire());
+		}
+
+		m_device.GetPresentQueue().Present(
+			{ renderFinishedSemaphore },
+			*m_swapChain,
+			swapImageIndex,
+			presentFence
+		);
+	}
+
+	void FrameScheduler::SetSwapChain(SwapChain& p_swapChain, std::unique_ptr<SwapChain> p_previousSwapChain)
+	{
+		assert(!m_currentFrame.has_value() && "the swap chain cannot be replaced during a frame");
+		assert((!p_previousSwapChain || p_previousSwapChain.get() == m_swapChain) && "only the current swap chain can be retired");
+
+		// Previous present semaphores may still be waited for by the presentation engine
+		RetireSwapChain(std::move(p_previousSwapChain));
+		ReleaseRetiredSwapChains(false);
+
+		m_swapChain = &p_swapChain;
+
+		const size_t imageCount = m_swapChain->GetImages().size();
+		m_renderFinishedSemaphores.reserve(imageCount);
+		for (size_t i = 0; i < imageCount; ++i)
+		{
+			m_renderFinishedSemaphores.push_back(&m_device.GetSemaphorePool().Acquire());
+		}
+	}
+
+	void FrameScheduler::RetireSwapChain(std::unique_ptr<SwapChain> p_swapChain)
+	{
+		if (!p_swapChain && m_renderFinishedSemaphores.empty())
+		{
+			return;
+		}
+
+		// Without present fences, an idle present queue is the only guarantee that presentations are complete
+		if (!m_usePresentFences)
+		{
+			m_device.GetPresentQueue().WaitIdle();
+		}
+
+		m_retiredSwapChains.push_back(RetiredSwapChain{
+			.swapChain = std::move(p_swapChain),
+			.presentSemaphores = std::move(m_renderFinishedSemaphores),
+			.presentFences = std::move(m_presentFences)
+		});
+
+		m_renderFinishedSemaphores.clear();
+		m_presentFences.clear();
+	}
+
+	void FrameScheduler::RecyclePresentFences()
+	{
+		std::erase_if(m_presentFences, [this](sync::Fence* p_fence) {
+			if (vkGetFenceStatus(m_device.GetLogicalDevice(), p_fence->GetHandle()) == VK_SUCCESS)
+			{
+				m_device.GetFencePool().Release(*p_fence);
+				return true;
+			}
+
+			return false;
+		});
+	}
+
+	void FrameScheduler::ReleaseRetiredSwapChains(bool p_wait)
+	{
+		// Retired swap chains are destroyed when erased
+		std::erase_if(m_retiredSwapChains, [&](RetiredSwapChain& p_retiredSwapChain) {
+			if (!AreSignaled(m_device.GetLogicalDevice(), p_retiredSwapChain.presentFences, p_wait))
+			{
+				return false;
+			}
+
+			for (auto fence : p_retiredSwapChain.presentFences)
+			{
+				m_device.GetFencePool().Release(*fence);
+			}
+
+			for (auto semaphore : p_retiredSwapChain.presentSemaphores)
+			{
+				m_device.GetSemaphorePool().Release(*semaphore);
+			}
+
+			return true;
+		});
+	}
+
+	uint32_t FrameScheduler::GetFramesInFlight() const
+	{
+		return m_framesInFlight;
+	}
+
+	uint64_t FrameScheduler::GetFrameNumber() const
+	{
+		return m_frameNumber;
+	}
+
+	sync::TimelineSemaphore& FrameScheduler::GetTimeline()
+	{
+		return m_timeline;
+	}
+
+	const FrameWaitTimes& FrameScheduler::GetLastWaitTimes() const
+	{
+		return m_lastWaitTimes;
+	}
+
+	const FrameWaitTimes& FrameScheduler::GetAverageWaitTimes() const
+	{
+		return m_averageWaitTimes;
+	}
+}
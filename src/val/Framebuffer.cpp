@@ -5,6 +5,7 @@
 */
 
 #include <val/Framebuffer.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -14,6 +15,8 @@ namespace val
 	Framebuffer::Framebuffer(VkDevice p_device, const FramebufferDesc& p_desc) :
 		m_device(p_device)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		VkFramebufferCreateInfo framebufferInfo{
 			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
 			.renderPass = p_desc.renderPass,
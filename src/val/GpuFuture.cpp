@@ -0,0 +1,70 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/GpuFuture.h>
+#include <cassert>
+#include <chrono>
+
+namespace val
+{
+	GpuFuture::GpuFuture(const sync::TimelineValue& p_value, GpuReactor& p_reactor) :
+		m_value(p_value),
+		m_reactor(p_reactor)
+	{
+	}
+
+	bool GpuFuture::IsReady() const
+	{
+		return m_value.semaphore.get().GetValue() >= m_value.value;
+	}
+
+	bool GpuFuture::Wait(std::optional<uint64_t> p_timeout) const
+	{
+		return m_value.semaphore.get().Wait(m_value.value, p_timeout);
+	}
+
+	const sync::TimelineValue& GpuFuture::GetTimelineValue() const
+	{
+		return m_value;
+	}
+
+	bool GpuFuture::await_ready() const
+	{
+		return IsReady();
+	}
+
+	bool GpuFuture::await_suspend(std::coroutine_handle<> p_coroutine) const
+	{
+		// Not suspended if the reactor has failed, since it would never be resumed
+		return m_reactor.Await(m_value, p_coroutine);
+	}
+
+	void GpuFuture::await_resume() const
+	{
+		// Resumed by a failed reactor
+		if (!IsReady())
+		{
+			const std::exception_ptr error = m_reactor.GetError();
+			assert(error && "a coroutine can only be resumed early by a failed reactor");
+			std::rethrow_exception(error);
+		}
+	}
+
+	GpuTask::GpuTask(std::future<void> p_future) :
+		m_future(std::move(p_future))
+	{
+	}
+
+	bool GpuTask::IsDone() const
+	{
+		return m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	void GpuTask::Wait()
+	{
+		m_future.get();
+	}
+}
@@ -0,0 +1,220 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/GpuProfiler.h>
+#include <val/Device.h>
+#include <val/CommandBuffer.h>
+#include <val/utils/CpuProfiler.h>
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace val
+{
+	GpuProfiler::GpuProfiler(
+		Device& p_device,
+		uint32_t p_framesInFlight,
+		uint32_t p_maxScopesPerFrame,
+		uint32_t p_historySize
+	) :
+		m_timestampPeriod(p_device.GetProperties().limits.timestampPeriod),
+		m_maxScopesPerFrame(p_maxScopesPerFrame),
+		m_historySize(p_historySize)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_framesInFlight > 0);
+
+		if (!p_device.GetProperties().limits.timestampComputeAndGraphics)
+		{
+			throw std::runtime_error("timestamp queries aren't supported by the device!");
+		}
+
+		m_slots.resize(p_framesInFlight);
+
+		for (auto& slot : m_slots)
+		{
+			// Two timestamps per scope (begin and end)
+			slot.queryPool = std::make_unique<QueryPool>(
+				p_device,
+				QueryPoolDesc{
+					.type = VK_QUERY_TYPE_TIMESTAMP,
+					.count = p_maxScopesPerFrame * 2
+				}
+			);
+		}
+	}
+
+	void GpuProfiler::BeginFrame()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(std::ranges::all_of(m_openScopes, [](const auto& p_entry) { return p_entry.second.empty(); }) &&
+			"every scope must be ended before a new frame begins");
+
+		m_openScopes.clear();
+		m_currentSlot = &m_slots[m_frameCount % m_slots.size()];
+
+		if (!m_currentSlot->scopes.empty())
+		{
+			CollectResults(*m_currentSlot);
+			m_currentSlot->queryPool->Reset(0, static_cast<uint32_t>(m_currentSlot->scopes.size()) * 2);
+		}
+
+		m_currentSlot->scopes.clear();
+		m_currentSlot->frameIndex = m_frameCount++;
+	}
+
+	void GpuProfiler::BeginScope(CommandBuffer& p_commandBuffer, std::string_view p_name)
+	{
+		assert(m_currentSlot && "BeginFrame() must be called before recording scopes");
+
+		uint32_t index;
+
+		{
+			std::lock_guard lock(m_scopesMutex);
+
+			auto& scopes = m_currentSlot->scopes;
+			auto& openScopes = m_openScopes[p_commandBuffer.GetHandle()];
+
+			// Scopes exceeding the frame capacity are ignored
+			if (scopes.size() >= m_maxScopesPerFrame)
+			{
+				openScopes.push_back(k_droppedScope);
+				return;
+			}
+
+			index = static_cast<uint32_t>(scopes.size());
+
+			std::optional<uint32_t> parent;
+			for (auto it = openScopes.rbegin(); it != openScopes.rend(); ++it)
+			{
+				if (*it != k_droppedScope)
+				{
+					parent = *it;
+					break;
+				}
+			}
+
+			scopes.push_back({
+				.name = std::string(p_name),
+				.depth = parent ? scopes[*parent].depth + 1 : 0,
+				.parent = parent
+			});
+
+			openScopes.push_back(index);
+		}
+
+		// The command buffer is only recorded by the calling thread, no need to hold the lock
+		p_commandBuffer.WriteTimestamp(*m_currentSlot->queryPool, index * 2, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT);
+	}
+
+	void GpuProfiler::EndScope(CommandBuffer& p_commandBuffer)
+	{
+		uint32_t index;
+
+		{
+			std::lock_guard lock(m_scopesMutex);
+
+			auto& openScopes = m_openScopes[p_commandBuffer.GetHandle()];
+			assert(!openScopes.empty() && "no scope to end on this command buffer");
+
+			index = openScopes.back();
+			openScopes.pop_back();
+		}
+
+		if (index != k_droppedScope)
+		{
+			p_commandBuffer.WriteTimestamp(*m_currentSlot->queryPool, index * 2 + 1, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
+		}
+	}
+
+	const GpuFrameTimings* GpuProfiler::GetLastFrameTimings() const
+	{
+		return m_history.empty() ? nullptr : &m_history.back();
+	}
+
+	const std::deque<GpuFrameTimings>& GpuProfiler::GetHistory() const
+	{
+		return m_history;
+	}
+
+	std::string GpuProfiler::ExportChromeTrace() const
+	{
+		std::ostringstream stream;
+		stream << std::fixed << std::setprecision(3); // Microseconds, without scientific notation
+		stream << "{\"traceEvents\":[";
+
+		bool first = true;
+		for (const auto& frame : m_history)
+		{
+			for (const auto& scope : frame.scopes)
+			{
+				stream << (first ? "" : ",")
+					<< "{\"name\":\"" << utils::CpuProfiler::EscapeJson(scope.name) << "\""
+					<< ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+					<< ",\"ts\":" << scope.startMs * 1000.0
+					<< ",\"dur\":" << scope.durationMs * 1000.0
+					<< ",\"args\":{\"frame\":" << frame.frameIndex << "}}";
+
+				first = false;
+			}
+		}
+
+		stream << "],\"displayTimeUnit\":\"ms\"}";
+
+		return stream.str();
+	}
+
+	void GpuProfiler::CollectResults(FrameSlot& p_slot)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const uint32_t queryCount = static_cast<uint32_t>(p_slot.scopes.size()) * 2;
+
+		std::vector<uint64_t> timestamps(queryCount);
+
+		// Results are dropped (rather than waited for) if the frame isn't complete yet
+		if (!p_slot.queryPool->GetResults(0, queryCount, timestamps))
+		{
+			return;
+		}
+
+		if (!m_epoch)
+		{
+			m_epoch = timestamps.front();
+		}
+
+		const auto toMilliseconds = [this](uint64_t p_ticks) {
+			return static_cast<double>(p_ticks) * m_timestampPeriod / 1000000.0;
+		};
+
+		GpuFrameTimings& frame = m_history.emplace_back();
+		frame.frameIndex = p_slot.frameIndex;
+		frame.scopes.reserve(p_slot.scopes.size());
+
+		for (size_t i = 0; i < p_slot.scopes.size(); ++i)
+		{
+			const uint64_t begin = timestamps[i * 2];
+			const uint64_t end = std::max(timestamps[i * 2 + 1], begin);
+
+			frame.scopes.push_back({
+				.name = std::move(p_slot.scopes[i].name),
+				.depth = p_slot.scopes[i].depth,
+				.parent = p_slot.scopes[i].parent,
+				.startMs = begin >= *m_epoch ? toMilliseconds(begin - *m_epoch) : 0.0,
+				.durationMs = toMilliseconds(end - begin)
+			});
+		}
+
+		while (m_history.size() > m_historySize)
+		{
+			m_history.pop_front();
+		}
+	}
+}
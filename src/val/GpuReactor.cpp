@@ -0,0 +1,166 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/GpuReactor.h>
+#include <val/utils/CpuProfiler.h>
+#include <limits>
+#include <stdexcept>
+
+namespace val
+{
+	GpuReactor::GpuReactor(VkDevice p_device) :
+		m_device(p_device),
+		m_wakeUpTimeline(p_device)
+	{
+		m_thread = std::jthread([this] { Run(); });
+	}
+
+	GpuReactor::~GpuReactor()
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_stop = true;
+			Wake();
+		}
+
+		m_thread.join();
+	}
+
+	bool GpuReactor::Await(const sync::TimelineValue& p_value, std::coroutine_handle<> p_coroutine)
+	{
+		std::scoped_lock lock(m_mutex);
+
+		if (m_error)
+		{
+			return false;
+		}
+
+		m_pendingAwaits.push_back({ p_value, p_coroutine });
+		Wake();
+		return true;
+	}
+
+	std::exception_ptr GpuReactor::GetError() const
+	{
+		std::scoped_lock lock(m_mutex);
+		return m_error;
+	}
+
+	void GpuReactor::Wake()
+	{
+		// Called with the mutex locked, so wake up values are signaled in order
+		m_wakeUpTimeline.Signal(++m_wakeUpValue);
+	}
+
+	void GpuReactor::Run()
+	{
+		std::vector<VkSemaphore> semaphores;
+		std::vector<uint64_t> values;
+		std::vector<std::coroutine_handle<>> readyCoroutines;
+
+		// An exception escaping the reactor thread would terminate the program
+		try
+		{
+			while (true)
+			{
+				semaphores.clear();
+				values.clear();
+
+				{
+					std::scoped_lock lock(m_mutex);
+
+					if (m_stop)
+					{
+						break;
+					}
+
+					// Any await added after this point signals the next wake up value, interrupting the wait
+					semaphores.push_back(m_wakeUpTimeline.GetHandle());
+					values.push_back(m_wakeUpValue + 1);
+
+					for (const auto& pendingAwait : m_pendingAwaits)
+					{
+						semaphores.push_back(pendingAwait.value.semaphore.get().GetHandle());
+						values.push_back(pendingAwait.value.value);
+					}
+				}
+
+				VkSemaphoreWaitInfo waitInfo{
+					.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+					.flags = VK_SEMAPHORE_WAIT_ANY_BIT,
+					.semaphoreCount = static_cast<uint32_t>(semaphores.size()),
+					.pSemaphores = semaphores.data(),
+					.pValues = values.data()
+				};
+
+				if (vkWaitSemaphores(m_device, &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS)
+				{
+					throw std::runtime_error("failed to wait for semaphores!");
+				}
+
+				VAL_PROFILE_SCOPE("GpuReactor::Resume");
+
+				{
+					std::scoped_lock lock(m_mutex);
+
+					std::erase_if(m_pendingAwaits, [&](const PendingAwait& p_pendingAwait) {
+						if (p_pendingAwait.value.semaphore.get().GetValue() >= p_pendingAwait.value.value)
+						{
+							readyCoroutines.push_back(p_pendingAwait.coroutine);
+							return true;
+						}
+
+						return false;
+					});
+				}
+
+				// Resumed outside of the lock, since coroutines may await again.
+				// Popped before being resumed, so a throwing coroutine is never resumed twice (see Fail()).
+				while (!readyCoroutines.empty())
+				{
+					const auto coroutine = readyCoroutines.back();
+					readyCoroutines.pop_back();
+					coroutine.resume();
+				}
+			}
+		}
+		catch (...)
+		{
+			Fail(std::current_exception(), readyCoroutines);
+		}
+	}
+
+	void GpuReactor::Fail(std::exception_ptr p_error, std::vector<std::coroutine_handle<>>& p_readyCoroutines)
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_error = p_error;
+
+			for (const auto& pendingAwait : m_pendingAwaits)
+			{
+				p_readyCoroutines.push_back(pendingAwait.coroutine);
+			}
+
+			m_pendingAwaits.clear();
+		}
+
+		// Coroutines not resumed yet observe the error when resumed (see GpuFuture::await_resume())
+		while (!p_readyCoroutines.empty())
+		{
+			const auto coroutine = p_readyCoroutines.back();
+			p_readyCoroutines.pop_back();
+
+			try
+			{
+				coroutine.resume();
+			}
+			catch (...)
+			{
+				// The reactor has already failed, and nothing else can be reported from its thread
+			}
+		}
+	}
+}
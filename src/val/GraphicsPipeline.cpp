@@ -5,176 +5,637 @@
 */
 
 #include <val/GraphicsPipeline.h>
+#include <val/CommandBuffer.h>
+#include <val/Device.h>
 #include <val/utils/ShaderUtils.h>
 #include <val/utils/MemoryUtils.h>
+#include <val/utils/HashUtils.h>
+#include <val/utils/CpuProfiler.h>
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
 
-namespace val
+namespace
 {
-	GraphicsPipeline::GraphicsPipeline(VkDevice p_device, const GraphicsPipelineDesc& p_desc) :
-		m_device(p_device)
+	VkPipelineLayout CreatePipelineLayout(VkDevice p_device, const val::GraphicsPipelineDesc& p_desc)
 	{
-		// Collect shader stages
-		const auto stages = p_desc.program.GetAssembledStages();
-
-		const auto dynamicStates = std::to_array({
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		});
+		// Push constant ranges beyond the guaranteed 128 bytes may not be supported by every device
+		for (const auto& range : p_desc.pushConstantRanges)
+		{
+			assert(range.offset + range.size <= val::CommandBuffer::k_maxPushConstantsSize && "push constant range exceeds the guaranteed limit");
+		}
 
-		// While most of the pipeline state needs to be baked into the pipeline state, a limited amount of the state can actually be
-		// changed without recreating the pipeline at draw time. Examples are the size of the viewport, line width and blend constants.
-		// If you want to use dynamic state and keep these properties out, then you'll have to fill in a VkPipelineDynamicStateCreateInfo
-		// structure like this:
-		VkPipelineDynamicStateCreateInfo dynamicState{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-			.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size()),
-			.pDynamicStates = dynamicStates.data()
+		const auto descriptorSetLayouts = val::utils::MemoryUtils::PrepareArray<VkDescriptorSetLayout>(p_desc.descriptorSetLayouts);
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+			.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()),
+			.pSetLayouts = descriptorSetLayouts.data(),
+			.pushConstantRangeCount = static_cast<uint32_t>(p_desc.pushConstantRanges.size()), // Optional
+			.pPushConstantRanges = p_desc.pushConstantRanges.data() // Optional
 		};
 
-		// Describes the format of the vertex data that will be passed to the vertex shader. It describes this in roughly two ways:
-		//	Bindings: spacing between data and whether the data is per - vertex or per - instance(see instancing)
-		//	Attribute descriptions : type of the attributes passed to the vertex shader, which binding to load them from and at which offset
-		VkPipelineVertexInputStateCreateInfo vertexInputState{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-			.vertexBindingDescriptionCount = static_cast<uint32_t>(p_desc.vertexInputBindingDesc.size()),
-			.pVertexBindingDescriptions = p_desc.vertexInputBindingDesc.data(), // Optional
-			.vertexAttributeDescriptionCount = static_cast<uint32_t>(p_desc.vertexInputAttributeDesc.size()),
-			.pVertexAttributeDescriptions = p_desc.vertexInputAttributeDesc.data() // Optional
-		};
+		VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
 
-		// The VkPipelineInputAssemblyStateCreateInfo struct describes two things:
-		// - what kind of geometry will be drawn from the vertices
-		// - if primitive restart should be enabled.
-		VkPipelineInputAssemblyStateCreateInfo inputAssemblyState{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-			.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-			.primitiveRestartEnable = VK_FALSE
-		};
+		if (vkCreatePipelineLayout(
+			p_device,
+			&pipelineLayoutInfo,
+			nullptr,
+			&pipelineLayout
+		) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
 
-		VkPipelineViewportStateCreateInfo viewportState{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-			.viewportCount = 1,
-			.pViewports = VK_NULL_HANDLE, // Dynamic viewport (VK_DYNAMIC_STATE_VIEWPORT)
-			.scissorCount = 1,
-			.pScissors = VK_NULL_HANDLE // Dynamic scissor (VK_DYNAMIC_STATE_SCISSOR)
-		};
+		return pipelineLayout;
+	}
 
-		VkPipelineRasterizationStateCreateInfo rasterizationState{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-			.depthClampEnable = VK_FALSE,
-			.rasterizerDiscardEnable = VK_FALSE,
-			.polygonMode = VK_POLYGON_MODE_FILL,
-			.cullMode = VK_CULL_MODE_BACK_BIT,
-			.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
-			.depthBiasEnable = VK_FALSE,
-			.depthBiasConstantFactor = 0.0f, // Optional
-			.depthBiasClamp = 0.0f, // Optional
-			.depthBiasSlopeFactor = 0.0f, // Optional
-			.lineWidth = 1.0f
-		};
+	// Baked values overridden by a dynamic state don't affect the compiled pipeline, so they are left out of keys
+	template<class T>
+	void AppendIfStatic(std::vector<std::byte>& p_key, const val::GraphicsPipelineDesc& p_desc, VkDynamicState p_state, const T& p_value)
+	{
+		if (!p_desc.IsDynamic(p_state))
+		{
+			val::utils::HashUtils::Append(p_key, p_value);
+		}
+	}
 
-		VkPipelineMultisampleStateCreateInfo multisampleState{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-			.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-			.sampleShadingEnable = VK_FALSE,
-			.minSampleShading = 1.0f, // Optional
-			.pSampleMask = nullptr, // Optional
-			.alphaToCoverageEnable = VK_FALSE, // Optional
-			.alphaToOneEnable = VK_FALSE // Optional
-		};
+	// With a dynamic topology, the topology used at draw time must still belong to the class of the baked one
+	// (unless dynamicPrimitiveTopologyUnrestricted is supported, which isn't assumed)
+	void AppendTopology(std::vector<std::byte>& p_key, const val::GraphicsPipelineDesc& p_desc)
+	{
+		if (!p_desc.IsDynamic(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY))
+		{
+			val::utils::HashUtils::Append(p_key, p_desc.topology);
+			return;
+		}
 
-		// If you are using a depth and/or stencil buffer, then you also need to configure the depth and stencil tests using
-		// VkPipelineDepthStencilStateCreateInfo. We don't have one right now, so we can simply pass a nullptr instead of a
-		// pointer to such a struct. We'll get back to it in the depth buffering chapter.
-
-		VkPipelineColorBlendAttachmentState colorBlendAttachmentState{
-			.blendEnable = VK_FALSE,
-			.srcColorBlendFactor = VK_BLEND_FACTOR_ONE, // Optional
-			.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO, // Optional
-			.colorBlendOp = VK_BLEND_OP_ADD, // Optional
-			.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE, // Optional
-			.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO, // Optional
-			.alphaBlendOp = VK_BLEND_OP_ADD, // Optional
-			.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
-		};
+		switch (p_desc.topology)
+		{
+		case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+		case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+			val::utils::HashUtils::Append(p_key, p_desc.topology);
+			break;
+
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+		case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+			val::utils::HashUtils::Append(p_key, VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+			break;
+
+		default:
+			val::utils::HashUtils::Append(p_key, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+			break;
+		}
+	}
+
+	void AppendDynamicStates(std::vector<std::byte>& p_key, const val::GraphicsPipelineDesc& p_desc)
+	{
+		// The order in which dynamic states are declared doesn't matter
+		std::vector<VkDynamicState> dynamicStates(p_desc.dynamicStates.begin(), p_desc.dynamicStates.end());
+		std::sort(dynamicStates.begin(), dynamicStates.end());
+		dynamicStates.erase(std::unique(dynamicStates.begin(), dynamicStates.end()), dynamicStates.end());
+
+		val::utils::HashUtils::AppendRange(p_key, std::span<const VkDynamicState>(dynamicStates));
+	}
+
+	void AppendColorBlendAttachment(std::vector<std::byte>& p_key, const val::GraphicsPipelineDesc& p_desc)
+	{
+		VkPipelineColorBlendAttachmentState colorBlendAttachment = p_desc.colorBlendAttachment;
 
-		VkPipelineColorBlendStateCreateInfo colorBlendState{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-			.logicOpEnable = VK_FALSE,
-			.logicOp = VK_LOGIC_OP_COPY, // Optional
-			.attachmentCount = 1,
-			.pAttachments = &colorBlendAttachmentState,
-			.blendConstants = {
-				0.0f, // Optional
-				0.0f, // Optional
-				0.0f, // Optional
-				0.0f // Optional
+		if (p_desc.IsDynamic(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT))
+		{
+			colorBlendAttachment.blendEnable = VK_FALSE;
+		}
+
+		if (p_desc.IsDynamic(VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT))
+		{
+			colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+			colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+			colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+		}
+
+		if (p_desc.IsDynamic(VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT))
+		{
+			colorBlendAttachment.colorWriteMask = 0;
+		}
+
+		val::utils::HashUtils::Append(p_key, colorBlendAttachment);
+	}
+
+	// Every state struct of a graphics pipeline, built from a description. Create infos returned by GetCreateInfo()
+	// point to this object, so it must outlive the pipeline creation.
+	class GraphicsPipelineState
+	{
+	public:
+		GraphicsPipelineState(const val::GraphicsPipelineDesc& p_desc) :
+			m_dynamicRendering(!p_desc.renderPass.has_value())
+		{
+			// Pre-rasterization and fragment shader stages are split, since they belong to different pipeline parts
+			for (const VkPipelineShaderStageCreateInfo& stage : p_desc.program.GetAssembledStages())
+			{
+				(stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT ? m_fragmentStages : m_preRasterizationStages).push_back(stage);
 			}
-		};
 
-		const auto descriptorSetLayouts = utils::MemoryUtils::PrepareArray<VkDescriptorSetLayout>(p_desc.descriptorSetLayouts);
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-			.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()),
-			.pSetLayouts = descriptorSetLayouts.data(),
-			.pushConstantRangeCount = 0, // Optional
-			.pPushConstantRanges = nullptr // Optional
-		};
+			m_stages = m_preRasterizationStages;
+			m_stages.insert(m_stages.end(), m_fragmentStages.begin(), m_fragmentStages.end());
 
-		if (vkCreatePipelineLayout(
+			m_dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+			for (const VkDynamicState dynamicState : p_desc.dynamicStates)
+			{
+				if (std::find(m_dynamicStates.begin(), m_dynamicStates.end(), dynamicState) == m_dynamicStates.end())
+				{
+					m_dynamicStates.push_back(dynamicState);
+				}
+			}
+
+			// While most of the pipeline state needs to be baked into the pipeline state, a limited amount of the state can actually be
+			// changed without recreating the pipeline at draw time. Examples are the size of the viewport, line width and blend constants.
+			// If you want to use dynamic state and keep these properties out, then you'll have to fill in a VkPipelineDynamicStateCreateInfo
+			// structure like this:
+			m_dynamicState = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+				.dynamicStateCount = static_cast<uint32_t>(m_dynamicStates.size()),
+				.pDynamicStates = m_dynamicStates.data()
+			};
+
+			// Describes the format of the vertex data that will be passed to the vertex shader. It describes this in roughly two ways:
+			//	Bindings: spacing between data and whether the data is per - vertex or per - instance(see instancing)
+			//	Attribute descriptions : type of the attributes passed to the vertex shader, which binding to load them from and at which offset
+			m_vertexInputState = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+				.vertexBindingDescriptionCount = static_cast<uint32_t>(p_desc.vertexInputBindingDesc.size()),
+				.pVertexBindingDescriptions = p_desc.vertexInputBindingDesc.data(), // Optional
+				.vertexAttributeDescriptionCount = static_cast<uint32_t>(p_desc.vertexInputAttributeDesc.size()),
+				.pVertexAttributeDescriptions = p_desc.vertexInputAttributeDesc.data() // Optional
+			};
+
+			// The VkPipelineInputAssemblyStateCreateInfo struct describes two things:
+			// - what kind of geometry will be drawn from the vertices
+			// - if primitive restart should be enabled.
+			m_inputAssemblyState = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+				.topology = p_desc.topology,
+				.primitiveRestartEnable = VK_FALSE
+			};
+
+			m_viewportState = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+				.viewportCount = 1,
+				.pViewports = VK_NULL_HANDLE, // Dynamic viewport (VK_DYNAMIC_STATE_VIEWPORT)
+				.scissorCount = 1,
+				.pScissors = VK_NULL_HANDLE // Dynamic scissor (VK_DYNAMIC_STATE_SCISSOR)
+			};
+
+			m_rasterizationState = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+				.depthClampEnable = VK_FALSE,
+				.rasterizerDiscardEnable = VK_FALSE,
+				.polygonMode = p_desc.polygonMode,
+				.cullMode = p_desc.cullMode,
+				.frontFace = p_desc.frontFace,
+				.depthBiasEnable = VK_FALSE,
+				.depthBiasConstantFactor = 0.0f, // Optional
+				.depthBiasClamp = 0.0f, // Optional
+				.depthBiasSlopeFactor = 0.0f, // Optional
+				.lineWidth = 1.0f
+			};
+
+			m_multisampleState = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+				.rasterizationSamples = p_desc.rasterizationSamples,
+				.sampleShadingEnable = VK_FALSE,
+				.minSampleShading = 1.0f, // Optional
+				.pSampleMask = nullptr, // Optional
+				.alphaToCoverageEnable = VK_FALSE, // Optional
+				.alphaToOneEnable = VK_FALSE // Optional
+			};
+
+			// Ignored if the render pass (or rendering) has no depth attachment
+			m_depthStencilState = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+				.depthTestEnable = p_desc.depthTestEnable ? VK_TRUE : VK_FALSE,
+				.depthWriteEnable = p_desc.depthWriteEnable ? VK_TRUE : VK_FALSE,
+				.depthCompareOp = p_desc.depthCompareOp,
+				.depthBoundsTestEnable = VK_FALSE,
+				.stencilTestEnable = VK_FALSE,
+				.minDepthBounds = 0.0f, // Optional
+				.maxDepthBounds = 1.0f // Optional
+			};
+
+			// With dynamic rendering, there is one blend state per color attachment format
+			const size_t colorAttachmentCount = m_dynamicRendering ? p_desc.colorAttachmentFormats.size() : 1;
+			m_colorBlendAttachmentStates.assign(colorAttachmentCount, p_desc.colorBlendAttachment);
+
+			m_colorBlendState = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+				.logicOpEnable = VK_FALSE,
+				.logicOp = VK_LOGIC_OP_COPY, // Optional
+				.attachmentCount = static_cast<uint32_t>(m_colorBlendAttachmentStates.size()),
+				.pAttachments = m_colorBlendAttachmentStates.data(),
+				.blendConstants = {
+					0.0f, // Optional
+					0.0f, // Optional
+					0.0f, // Optional
+					0.0f // Optional
+				}
+			};
+
+			// Without a render pass, attachment formats are provided to the pipeline directly (VK_KHR_dynamic_rendering)
+			m_renderingInfo = {
+				.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+				.colorAttachmentCount = static_cast<uint32_t>(p_desc.colorAttachmentFormats.size()),
+				.pColorAttachmentFormats = p_desc.colorAttachmentFormats.data(),
+				.depthAttachmentFormat = p_desc.depthAttachmentFormat,
+				.stencilAttachmentFormat = VK_FORMAT_UNDEFINED
+			};
+
+			m_renderPass = m_dynamicRendering ? VK_NULL_HANDLE : p_desc.renderPass->get().GetHandle();
+		}
+
+		GraphicsPipelineState(const GraphicsPipelineState&) = delete;
+
+		// Returns the create info of a complete pipeline, or of a single part of it (graphics pipeline library)
+		VkGraphicsPipelineCreateInfo GetCreateInfo(VkPipelineLayout p_layout, std::optional<val::EGraphicsPipelinePart> p_part = std::nullopt)
+		{
+			using enum val::EGraphicsPipelinePart;
+
+			const bool vertexInput = !p_part.has_value() || p_part == VertexInput;
+			const bool preRasterization = !p_part.has_value() || p_part == PreRasterization;
+			const bool fragmentShader = !p_part.has_value() || p_part == FragmentShader;
+			const bool fragmentOutput = !p_part.has_value() || p_part == FragmentOutput;
+
+			const std::vector<VkPipelineShaderStageCreateInfo>& stages =
+				!p_part.has_value() ? m_stages :
+				preRasterization ? m_preRasterizationStages :
+				fragmentShader ? m_fragmentStages :
+				m_noStages;
+
+			m_libraryInfo = {
+				.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+				.pNext = m_dynamicRendering ? &m_renderingInfo : nullptr,
+				.flags = p_part.has_value() ? k_libraryFlags[static_cast<size_t>(p_part.value())] : 0
+			};
+
+			// The vertex input part doesn't depend on the layout, nor on the render pass
+			return VkGraphicsPipelineCreateInfo{
+				.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+				.pNext = p_part.has_value() ? static_cast<const void*>(&m_libraryInfo) : m_dynamicRendering ? &m_renderingInfo : nullptr,
+				.flags = p_part.has_value() ? VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT : 0u,
+				.stageCount = static_cast<uint32_t>(stages.size()),
+				.pStages = stages.data(),
+				.pVertexInputState = vertexInput ? &m_vertexInputState : nullptr,
+				.pInputAssemblyState = vertexInput ? &m_inputAssemblyState : nullptr,
+				.pViewportState = preRasterization ? &m_viewportState : nullptr,
+				.pRasterizationState = preRasterization ? &m_rasterizationState : nullptr,
+				.pMultisampleState = fragmentShader || fragmentOutput ? &m_multisampleState : nullptr,
+				.pDepthStencilState = fragmentShader ? &m_depthStencilState : nullptr,
+				.pColorBlendState = fragmentOutput ? &m_colorBlendState : nullptr,
+				.pDynamicState = &m_dynamicState,
+				.layout = preRasterization || fragmentShader ? p_layout : VK_NULL_HANDLE,
+				.renderPass = vertexInput && p_part.has_value() ? VK_NULL_HANDLE : m_renderPass
+			};
+		}
+
+	private:
+		static constexpr auto k_libraryFlags = std::to_array<VkGraphicsPipelineLibraryFlagsEXT>({
+			VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+			VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT
+		});
+
+		const bool m_dynamicRendering;
+		std::vector<VkPipelineShaderStageCreateInfo> m_stages;
+		std::vector<VkPipelineShaderStageCreateInfo> m_preRasterizationStages;
+		std::vector<VkPipelineShaderStageCreateInfo> m_fragmentStages;
+		const std::vector<VkPipelineShaderStageCreateInfo> m_noStages;
+		std::vector<VkDynamicState> m_dynamicStates;
+		VkPipelineDynamicStateCreateInfo m_dynamicState;
+		VkPipelineVertexInputStateCreateInfo m_vertexInputState;
+		VkPipelineInputAssemblyStateCreateInfo m_inputAssemblyState;
+		VkPipelineViewportStateCreateInfo m_viewportState;
+		VkPipelineRasterizationStateCreateInfo m_rasterizationState;
+		VkPipelineMultisampleStateCreateInfo m_multisampleState;
+		VkPipelineDepthStencilStateCreateInfo m_depthStencilState;
+		std::vector<VkPipelineColorBlendAttachmentState> m_colorBlendAttachmentStates;
+		VkPipelineColorBlendStateCreateInfo m_colorBlendState;
+		VkPipelineRenderingCreateInfo m_renderingInfo;
+		VkGraphicsPipelineLibraryCreateInfoEXT m_libraryInfo;
+		VkRenderPass m_renderPass = VK_NULL_HANDLE;
+	};
+}
+
+namespace val
+{
+	GraphicsPipelineKey GraphicsPipelineDesc::GetKey() const
+	{
+		using utils::HashUtils;
+
+		GraphicsPipelineKey key{ .stages = program.GetKeys() };
+		std::vector<std::byte>& state = key.state;
+
+		HashUtils::AppendRange(state, vertexInputAttributeDesc);
+		HashUtils::AppendRange(state, vertexInputBindingDesc);
+
+		// Pipeline layouts are compatible if their set layouts and push constant ranges are identical
+		HashUtils::AppendRange(state, std::span<const VkDescriptorSetLayout>(
+			utils::MemoryUtils::PrepareArray<VkDescriptorSetLayout>(descriptorSetLayouts)
+		));
+		HashUtils::AppendRange(state, pushConstantRanges);
+
+		// A pipeline can be used with any compatible render pass, so the render pass is identified by its format, not its handle
+		HashUtils::Append(state, renderPass.has_value() ? renderPass->get().GetFormat() : VK_FORMAT_UNDEFINED);
+		HashUtils::AppendRange(state, colorAttachmentFormats);
+		HashUtils::Append(state, depthAttachmentFormat);
+
+		AppendDynamicStates(state, *this);
+		AppendTopology(state, *this);
+		AppendIfStatic(state, *this, VK_DYNAMIC_STATE_POLYGON_MODE_EXT, polygonMode);
+		AppendIfStatic(state, *this, VK_DYNAMIC_STATE_CULL_MODE, cullMode);
+		AppendIfStatic(state, *this, VK_DYNAMIC_STATE_FRONT_FACE, frontFace);
+		AppendIfStatic(state, *this, VK_DYNAMIC_STATE_RASTERIZATION_SAMPLES_EXT, rasterizationSamples);
+		AppendIfStatic(state, *this, VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE, static_cast<VkBool32>(depthTestEnable));
+		AppendIfStatic(state, *this, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE, static_cast<VkBool32>(depthWriteEnable));
+		AppendIfStatic(state, *this, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP, depthCompareOp);
+		AppendColorBlendAttachment(state, *this);
+
+		return key;
+	}
+
+	uint64_t GraphicsPipelineDesc::GetHash() const
+	{
+		return GetKey().GetHash();
+	}
+
+	bool GraphicsPipelineDesc::IsDynamic(VkDynamicState p_state) const
+	{
+		return std::find(dynamicStates.begin(), dynamicStates.end(), p_state) != dynamicStates.end();
+	}
+
+	GraphicsPipelinePart::GraphicsPipelinePart(Device& p_device, EGraphicsPipelinePart p_part, const GraphicsPipelineDesc& p_desc) :
+		m_device(p_device.GetLogicalDevice()),
+		m_part(p_part)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_device.IsGraphicsPipelineLibrarySupported() && "graphics pipeline libraries aren't supported");
+
+		// Shader parts are compiled with the complete layout, which is identically defined in both parts
+		if (m_part == EGraphicsPipelinePart::PreRasterization || m_part == EGraphicsPipelinePart::FragmentShader)
+		{
+			m_pipelineLayout = CreatePipelineLayout(m_device, p_desc);
+		}
+
+		GraphicsPipelineState state(p_desc);
+		const VkGraphicsPipelineCreateInfo createInfo = state.GetCreateInfo(m_pipelineLayout, m_part);
+
+		if (vkCreateGraphicsPipelines(
 			m_device,
-			&pipelineLayoutInfo,
+			p_device.GetPipelineCache().GetHandle(),
+			1,
+			&createInfo,
 			nullptr,
-			&m_pipelineLayout
+			&m_handle
 		) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create pipeline layout!");
+			vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+			throw std::runtime_error("failed to create graphics pipeline library!");
 		}
+	}
 
-		VkGraphicsPipelineCreateInfo createInfo{
-			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-			.stageCount = static_cast<uint32_t>(stages.size()),
-			.pStages = stages.data(),
-			.pVertexInputState = &vertexInputState,
-			.pInputAssemblyState = &inputAssemblyState,
-			.pViewportState = &viewportState,
-			.pRasterizationState = &rasterizationState,
-			.pMultisampleState = &multisampleState,
-			.pColorBlendState = &colorBlendState,
-			.pDynamicState = &dynamicState,
-			.layout = m_pipelineLayout,
-			.renderPass = p_desc.renderPass.GetHandle(),
+	GraphicsPipelinePart::~GraphicsPipelinePart()
+	{
+		vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+		vkDestroyPipeline(m_device, m_handle, nullptr);
+	}
+
+	EGraphicsPipelinePart GraphicsPipelinePart::GetPart() const
+	{
+		return m_part;
+	}
+
+	VkPipeline GraphicsPipelinePart::GetHandle() const
+	{
+		return m_handle;
+	}
+
+	GraphicsPipelineKey GraphicsPipelinePart::GetKey(EGraphicsPipelinePart p_part, const GraphicsPipelineDesc& p_desc)
+	{
+		using utils::HashUtils;
+
+		GraphicsPipelineKey key;
+		std::vector<std::byte>& state = key.state;
+		HashUtils::Append(state, p_part);
+
+		// Dynamic states are ignored by parts not containing their state, but for simplicity, every part depends on them
+		AppendDynamicStates(state, p_desc);
+
+		auto appendLayout = [&] {
+			HashUtils::AppendRange(state, std::span<const VkDescriptorSetLayout>(
+				utils::MemoryUtils::PrepareArray<VkDescriptorSetLayout>(p_desc.descriptorSetLayouts)
+			));
+			HashUtils::AppendRange(state, p_desc.pushConstantRanges);
 		};
 
+		// Every part but the vertex input one is tied to the render pass (if any)
+		if (p_part != EGraphicsPipelinePart::VertexInput)
+		{
+			HashUtils::Append(state, p_desc.renderPass.has_value() ? p_desc.renderPass->get().GetFormat() : VK_FORMAT_UNDEFINED);
+		}
+
+		switch (p_part)
+		{
+		case EGraphicsPipelinePart::VertexInput:
+			HashUtils::AppendRange(state, p_desc.vertexInputAttributeDesc);
+			HashUtils::AppendRange(state, p_desc.vertexInputBindingDesc);
+			AppendTopology(state, p_desc);
+			break;
+
+		case EGraphicsPipelinePart::PreRasterization:
+			key.stages = p_desc.program.GetKeys(~static_cast<VkShaderStageFlags>(VK_SHADER_STAGE_FRAGMENT_BIT));
+			appendLayout();
+			AppendIfStatic(state, p_desc, VK_DYNAMIC_STATE_POLYGON_MODE_EXT, p_desc.polygonMode);
+			AppendIfStatic(state, p_desc, VK_DYNAMIC_STATE_CULL_MODE, p_desc.cullMode);
+			AppendIfStatic(state, p_desc, VK_DYNAMIC_STATE_FRONT_FACE, p_desc.frontFace);
+			break;
+
+		case EGraphicsPipelinePart::FragmentShader:
+			key.stages = p_desc.program.GetKeys(VK_SHADER_STAGE_FRAGMENT_BIT);
+			appendLayout();
+			AppendIfStatic(state, p_desc, VK_DYNAMIC_STATE_RASTERIZATION_SAMPLES_EXT, p_desc.rasterizationSamples);
+			AppendIfStatic(state, p_desc, VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE, static_cast<VkBool32>(p_desc.depthTestEnable));
+			AppendIfStatic(state, p_desc, VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE, static_cast<VkBool32>(p_desc.depthWriteEnable));
+			AppendIfStatic(state, p_desc, VK_DYNAMIC_STATE_DEPTH_COMPARE_OP, p_desc.depthCompareOp);
+			break;
+
+		case EGraphicsPipelinePart::FragmentOutput:
+			HashUtils::AppendRange(state, p_desc.colorAttachmentFormats);
+			HashUtils::Append(state, p_desc.depthAttachmentFormat);
+			AppendIfStatic(state, p_desc, VK_DYNAMIC_STATE_RASTERIZATION_SAMPLES_EXT, p_desc.rasterizationSamples);
+			AppendColorBlendAttachment(state, p_desc);
+			break;
+		}
+
+		return key;
+	}
+
+	uint64_t GraphicsPipelinePart::GetHash(EGraphicsPipelinePart p_part, const GraphicsPipelineDesc& p_desc)
+	{
+		return GetKey(p_part, p_desc).GetHash();
+	}
+
+	uint64_t GraphicsPipelineKey::GetHash() const
+	{
+		uint64_t hash = 0;
+
+		for (const auto& stage : stages)
+		{
+			utils::HashUtils::Combine(hash, stage->hash);
+		}
+
+		return utils::HashUtils::HashBytes(state, hash);
+	}
+
+	bool GraphicsPipelineKey::operator==(const GraphicsPipelineKey& p_other) const
+	{
+		// Keys built from the same program share their stage keys, so byte code is only compared across programs
+		return
+			state == p_other.state &&
+			std::equal(stages.begin(), stages.end(), p_other.stages.begin(), p_other.stages.end(), [](const auto& p_lhs, const auto& p_rhs) {
+				return p_lhs == p_rhs || *p_lhs == *p_rhs;
+			});
+	}
+
+	GraphicsPipeline::GraphicsPipeline(Device& p_device, const GraphicsPipelineDesc& p_desc) :
+		m_device(p_device.GetLogicalDevice()),
+		m_pipelineCache(p_device.GetPipelineCache().GetHandle())
+	{
+		VAL_PROFILE_FUNCTION();
+
+		m_pipelineLayout = CreatePipelineLayout(m_device, p_desc);
+
+		GraphicsPipelineState state(p_desc);
+		const VkGraphicsPipelineCreateInfo createInfo = state.GetCreateInfo(m_pipelineLayout);
+
 		if (vkCreateGraphicsPipelines(
 			m_device,
-			VK_NULL_HANDLE,
+			m_pipelineCache,
 			1,
 			&createInfo,
 			nullptr,
 			&m_graphicsPipeline
 		) != VK_SUCCESS) {
+			vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
 			throw std::runtime_error("failed to create graphics pipeline!");
 		}
 	}
 
+	GraphicsPipeline::GraphicsPipeline(
+		Device& p_device,
+		const GraphicsPipelineDesc& p_desc,
+		std::span<const std::reference_wrapper<const GraphicsPipelinePart>, k_partCount> p_parts
+	) :
+		m_device(p_device.GetLogicalDevice()),
+		m_pipelineCache(p_device.GetPipelineCache().GetHandle())
+	{
+		VAL_PROFILE_FUNCTION();
+
+		m_libraries.reserve(p_parts.size());
+		for (const auto& part : p_parts)
+		{
+			m_libraries.push_back(part.get().GetHandle());
+		}
+
+		// The linked pipeline layout must be compatible with the layout of each shader part
+		m_pipelineLayout = CreatePipelineLayout(m_device, p_desc);
+
+		// No link-time optimizations, so the link is as fast as possible
+		m_graphicsPipeline = Link(0);
+
+		if (m_graphicsPipeline == VK_NULL_HANDLE)
+		{
+			vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+			throw std::runtime_error("failed to link graphics pipeline!");
+		}
+	}
+
 	GraphicsPipeline::~GraphicsPipeline()
 	{
 		vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
 		vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
+		vkDestroyPipeline(m_device, m_optimizedPipeline.load(), nullptr);
+	}
+
+	void GraphicsPipeline::Optimize()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::scoped_lock lock(m_optimizeMutex);
+
+		if (IsOptimized())
+		{
+			return;
+		}
+
+		// On failure, the fast-linked pipeline keeps being used
+		m_optimizedPipeline.store(Link(VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT), std::memory_order_release);
+	}
+
+	bool GraphicsPipeline::IsLinked() const
+	{
+		return !m_libraries.empty();
+	}
+
+	bool GraphicsPipeline::IsOptimized() const
+	{
+		return !IsLinked() || m_optimizedPipeline.load(std::memory_order_acquire) != VK_NULL_HANDLE;
 	}
 
 	VkPipeline GraphicsPipeline::GetHandle() const
 	{
-		return m_graphicsPipeline;
+		const VkPipeline optimizedPipeline = m_optimizedPipeline.load(std::memory_order_acquire);
+		return optimizedPipeline != VK_NULL_HANDLE ? optimizedPipeline : m_graphicsPipeline;
 	}
 
 	VkPipelineLayout GraphicsPipeline::GetLayout() const
 	{
 		return m_pipelineLayout;
 	}
+
+	VkPipeline GraphicsPipeline::Link(VkPipelineCreateFlags p_flags) const
+	{
+		VkPipelineLibraryCreateInfoKHR libraryInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+			.libraryCount = static_cast<uint32_t>(m_libraries.size()),
+			.pLibraries = m_libraries.data()
+		};
+
+		// Every state is provided by the libraries
+		VkGraphicsPipelineCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = &libraryInfo,
+			.flags = p_flags,
+			.layout = m_pipelineLayout
+		};
+
+		VkPipeline pipeline = VK_NULL_HANDLE;
+
+		if (vkCreateGraphicsPipelines(
+			m_device,
+			m_pipelineCache,
+			1,
+			&createInfo,
+			nullptr,
+			&pipeline
+		) != VK_SUCCESS) {
+			return VK_NULL_HANDLE;
+		}
+
+		return pipeline;
+	}
 }
@@ -0,0 +1,149 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/Image.h>
+#include <val/Device.h>
+#include <val/utils/MemoryUtils.h>
+#include <val/utils/CpuProfiler.h>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+namespace val
+{
+	Image::Image(Device& p_device, const ImageDesc& p_desc) :
+		m_device(p_device),
+		m_desc(p_desc)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		VkImageCreateInfo imageInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType = VK_IMAGE_TYPE_2D,
+			.format = p_desc.format,
+			.extent = p_desc.extent,
+			.mipLevels = p_desc.mipLevels,
+			.arrayLayers = p_desc.arrayLayers,
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.tiling = VK_IMAGE_TILING_OPTIMAL,
+			.usage = p_desc.usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+		};
+
+		if (vkCreateImage(
+			m_device.GetLogicalDevice(),
+			&imageInfo,
+			nullptr,
+			&m_handle
+		) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create image!");
+		}
+	}
+
+	Image::Image(Device& p_device, VkImage p_handle, const ImageDesc& p_desc) :
+		m_device(p_device),
+		m_desc(p_desc),
+		m_owned(false),
+		m_handle(p_handle)
+	{
+	}
+
+	Image::~Image()
+	{
+		if (!m_owned)
+		{
+			return;
+		}
+
+		if (IsAllocated())
+		{
+			Deallocate();
+		}
+
+		vkDestroyImage(m_device.GetLogicalDevice(), m_handle, nullptr);
+	}
+
+	bool Image::IsAllocated() const
+	{
+		return m_memory != VK_NULL_HANDLE;
+	}
+
+	void Image::Allocate(VkMemoryPropertyFlags p_properties)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(m_owned && "cannot allocate memory for an image that isn't owned");
+		assert(!IsAllocated());
+
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(m_device.GetLogicalDevice(), m_handle, &memRequirements);
+
+		VkMemoryAllocateInfo allocInfo{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.allocationSize = memRequirements.size,
+			.memoryTypeIndex = utils::MemoryUtils::FindMemoryType(
+				m_device.GetPhysicalDevice(),
+				memRequirements.memoryTypeBits,
+				p_properties
+			)
+		};
+
+		if (vkAllocateMemory(
+			m_device.GetLogicalDevice(),
+			&allocInfo,
+			nullptr,
+			&m_memory
+		) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate image memory!");
+		}
+
+		vkBindImageMemory(m_device.GetLogicalDevice(), m_handle, m_memory, 0);
+	}
+
+	void Image::Deallocate()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(IsAllocated());
+
+		vkFreeMemory(m_device.GetLogicalDevice(), m_memory, nullptr);
+		m_memory = VK_NULL_HANDLE;
+	}
+
+	const ImageDesc& Image::GetDesc() const
+	{
+		return m_desc;
+	}
+
+	VkImageSubresourceRange Image::GetSubresourceRange() const
+	{
+		return VkImageSubresourceRange{
+			.aspectMask = m_desc.aspectMask,
+			.baseMipLevel = 0,
+			.levelCount = m_desc.mipLevels,
+			.baseArrayLayer = 0,
+			.layerCount = m_desc.arrayLayers
+		};
+	}
+
+	VkImage Image::GetHandle() const
+	{
+		return m_handle;
+	}
+
+	const sync::ResourceState& Image::GetState() const
+	{
+		return m_state;
+	}
+
+	void Image::SetState(const sync::ResourceState& p_state)
+	{
+		m_state = p_state;
+	}
+}
@@ -5,6 +5,7 @@
 */
 
 #include <val/Instance.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <optional>
@@ -14,6 +15,8 @@ namespace val
 {
 	Instance::Instance(const InstanceDesc& desc)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		m_extensionManager.FetchExtensions<utils::EExtensionHandler::Instance>();
 
 		m_extensionManager.LogExtensions();
@@ -34,6 +37,10 @@ namespace val
 			requestedExtensions.emplace_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME, true);
 		};
 
+		// (optional) surface maintenance, required by swap chain maintenance (present fences) on the device side
+		requestedExtensions.emplace_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME, false);
+		requestedExtensions.emplace_back(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME, false);
+
 		for (auto& extension : desc.requiredExtensions)
 		{
 			requestedExtensions.emplace_back(extension, true); // "true" to make it required
@@ -57,7 +64,7 @@ namespace val
 			.applicationVersion = VK_MAKE_VERSION(1, 0, 0),
 			.pEngineName = "No Engine",
 			.engineVersion = VK_MAKE_VERSION(1, 0, 0),
-			.apiVersion = VK_API_VERSION_1_0
+			.apiVersion = VK_API_VERSION_1_3
 		};
 
 		VkInstanceCreateInfo createInfo{
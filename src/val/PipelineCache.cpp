@@ -0,0 +1,180 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/PipelineCache.h>
+#include <val/Device.h>
+#include <val/utils/CpuProfiler.h>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+	std::vector<std::byte> ReadFile(const std::filesystem::path& p_path)
+	{
+		std::ifstream file(p_path, std::ios::ate | std::ios::binary);
+
+		if (!file.is_open())
+		{
+			return {};
+		}
+
+		std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+		return file ? data : std::vector<std::byte>{};
+	}
+}
+
+namespace val
+{
+	PipelineCache::PipelineCache(Device& p_device, std::optional<std::filesystem::path> p_path) :
+		m_device(p_device),
+		m_path(std::move(p_path))
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::vector<std::byte> initialData;
+
+		if (m_path.has_value())
+		{
+			initialData = ReadFile(m_path.value());
+
+			if (!IsCompatible(initialData))
+			{
+				initialData.clear();
+			}
+		}
+
+		VkPipelineCacheCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+			.initialDataSize = initialData.size(),
+			.pInitialData = initialData.empty() ? nullptr : initialData.data()
+		};
+
+		if (vkCreatePipelineCache(
+			m_device.GetLogicalDevice(),
+			&createInfo,
+			nullptr,
+			&m_handle
+		) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+
+		m_loadedFromDisk = !initialData.empty();
+		m_savedSize = initialData.size();
+	}
+
+	PipelineCache::~PipelineCache()
+	{
+		if (m_path.has_value() && !Save())
+		{
+			std::cerr << "failed to save pipeline cache to " << m_path->string() << std::endl;
+		}
+
+		vkDestroyPipelineCache(m_device.GetLogicalDevice(), m_handle, nullptr);
+	}
+
+	bool PipelineCache::Save()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		if (!m_path.has_value())
+		{
+			return false;
+		}
+
+		// Serializes saves, which share the temporary file and the saved size
+		std::scoped_lock lock(m_saveMutex);
+
+		std::vector<std::byte> data;
+		size_t size = 0;
+		VkResult result = VK_SUCCESS;
+
+		// Pipelines may be compiled concurrently, growing the cache between the size query and the data query
+		// (VK_INCOMPLETE), in which case the size is queried again
+		do
+		{
+			if (vkGetPipelineCacheData(m_device.GetLogicalDevice(), m_handle, &size, nullptr) != VK_SUCCESS)
+			{
+				return false;
+			}
+
+			// Pipeline caches only grow, so an unchanged size means there is nothing new to save
+			if (size == m_savedSize)
+			{
+				return true;
+			}
+
+			data.resize(size);
+			result = vkGetPipelineCacheData(m_device.GetLogicalDevice(), m_handle, &size, data.data());
+		} while (result == VK_INCOMPLETE);
+
+		if (result != VK_SUCCESS)
+		{
+			return false;
+		}
+
+		std::filesystem::path temporaryPath = m_path.value();
+		temporaryPath += ".tmp";
+
+		{
+			std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(data.data()), size);
+
+			if (!file)
+			{
+				return false;
+			}
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporaryPath, m_path.value(), error);
+
+		if (error)
+		{
+			return false;
+		}
+
+		m_savedSize = size;
+		return true;
+	}
+
+	bool PipelineCache::IsLoadedFromDisk() const
+	{
+		return m_loadedFromDisk;
+	}
+
+	VkPipelineCache PipelineCache::GetHandle() const
+	{
+		return m_handle;
+	}
+
+	bool PipelineCache::IsCompatible(std::span<const std::byte> p_data) const
+	{
+		VkPipelineCacheHeaderVersionOne header;
+
+		if (p_data.size() < sizeof(header))
+		{
+			return false;
+		}
+
+		std::memcpy(&header, p_data.data(), sizeof(header));
+
+		const VkPhysicalDeviceProperties& properties = m_device.GetProperties();
+
+		return
+			header.headerSize >= sizeof(header) &&
+			header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			header.vendorID == properties.vendorID &&
+			header.deviceID == properties.deviceID &&
+			std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+	}
+}
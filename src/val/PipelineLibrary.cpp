@@ -0,0 +1,339 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/PipelineLibrary.h>
+#include <val/Device.h>
+#include <val/utils/CpuProfiler.h>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+
+namespace
+{
+	constexpr size_t k_initialCapacity = 64;
+
+	// Owns a copy of everything a GraphicsPipelineDesc references through spans, for deferred compilation
+	struct GraphicsPipelineDescStorage
+	{
+		std::vector<VkVertexInputAttributeDescription> vertexInputAttributeDesc;
+		std::vector<VkVertexInputBindingDescription> vertexInputBindingDesc;
+		std::vector<std::reference_wrapper<val::DescriptorSetLayout>> descriptorSetLayouts;
+		std::vector<VkPushConstantRange> pushConstantRanges;
+		std::vector<VkFormat> colorAttachmentFormats;
+		std::vector<VkDynamicState> dynamicStates;
+		val::GraphicsPipelineDesc desc;
+
+		GraphicsPipelineDescStorage(const val::GraphicsPipelineDesc& p_desc) :
+			vertexInputAttributeDesc(p_desc.vertexInputAttributeDesc.begin(), p_desc.vertexInputAttributeDesc.end()),
+			vertexInputBindingDesc(p_desc.vertexInputBindingDesc.begin(), p_desc.vertexInputBindingDesc.end()),
+			descriptorSetLayouts(p_desc.descriptorSetLayouts.begin(), p_desc.descriptorSetLayouts.end()),
+			pushConstantRanges(p_desc.pushConstantRanges.begin(), p_desc.pushConstantRanges.end()),
+			colorAttachmentFormats(p_desc.colorAttachmentFormats.begin(), p_desc.colorAttachmentFormats.end()),
+			dynamicStates(p_desc.dynamicStates.begin(), p_desc.dynamicStates.end()),
+			desc(p_desc)
+		{
+			desc.vertexInputAttributeDesc = vertexInputAttributeDesc;
+			desc.vertexInputBindingDesc = vertexInputBindingDesc;
+			desc.descriptorSetLayouts = descriptorSetLayouts;
+			desc.pushConstantRanges = pushConstantRanges;
+			desc.colorAttachmentFormats = colorAttachmentFormats;
+			desc.dynamicStates = dynamicStates;
+		}
+	};
+}
+
+namespace val
+{
+	PipelineLibrary::Handle::Handle(const Entry& p_entry) :
+		m_entry(&p_entry)
+	{
+	}
+
+	bool PipelineLibrary::Handle::IsValid() const
+	{
+		return m_entry != nullptr;
+	}
+
+	bool PipelineLibrary::Handle::IsReady() const
+	{
+		return m_entry && m_entry->state.load(std::memory_order_acquire) == EPipelineState::Ready;
+	}
+
+	bool PipelineLibrary::Handle::HasFailed() const
+	{
+		return m_entry && m_entry->state.load(std::memory_order_acquire) == EPipelineState::Failed;
+	}
+
+	void PipelineLibrary::Handle::Wait() const
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(IsValid());
+		m_entry->state.wait(EPipelineState::Pending, std::memory_order_acquire);
+	}
+
+	GraphicsPipeline* PipelineLibrary::Handle::TryGet() const
+	{
+		return IsReady() ? m_entry->pipeline.get() : nullptr;
+	}
+
+	GraphicsPipeline& PipelineLibrary::Handle::Get() const
+	{
+		assert(IsReady() && "pipeline isn't ready");
+		return *m_entry->pipeline;
+	}
+
+	PipelineLibrary::PipelineLibrary(Device& p_device, const PipelineLibraryDesc& p_desc) :
+		m_device(p_device),
+		m_useGraphicsPipelineLibraries(p_desc.useGraphicsPipelineLibraries && p_device.IsGraphicsPipelineLibrarySupported()),
+		m_optimizeInBackground(p_desc.optimizeInBackground),
+		m_compileThreads(std::make_unique<utils::ThreadPool>(p_desc.compileThreadCount))
+	{
+		m_tables.push_back(std::make_unique<Table>(k_initialCapacity));
+		m_table.store(m_tables.back().get(), std::memory_order_release);
+	}
+
+	PipelineLibrary::~PipelineLibrary()
+	{
+		// Pending compilations reference entries, so they must complete first
+		m_compileThreads.reset();
+
+		m_table.store(nullptr, std::memory_order_release);
+		m_entries.clear();
+		m_tables.clear();
+
+		// Linked pipelines must be destroyed before their parts
+		m_parts.clear();
+	}
+
+	GraphicsPipeline& PipelineLibrary::GetOrCreate(const GraphicsPipelineDesc& p_desc)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		auto [entry, created] = Claim(p_desc.GetKey());
+
+		if (created)
+		{
+			Compile(*entry, p_desc);
+		}
+
+		Handle handle(*entry);
+		handle.Wait();
+
+		if (handle.HasFailed())
+		{
+			throw std::runtime_error("failed to create graphics pipeline!");
+		}
+
+		return handle.Get();
+	}
+
+	PipelineLibrary::Handle PipelineLibrary::RequestAsync(const GraphicsPipelineDesc& p_desc)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		auto [entry, created] = Claim(p_desc.GetKey());
+
+		if (created)
+		{
+			// std::function must be copyable, so the description copy is held by a shared pointer
+			m_compileThreads->Enqueue([this, entry, storage = std::make_shared<GraphicsPipelineDescStorage>(p_desc)] {
+				try
+				{
+					Compile(*entry, storage->desc);
+				}
+				catch (const std::exception&)
+				{
+					// Reported through the handle (EPipelineState::Failed)
+				}
+			});
+		}
+
+		return Handle(*entry);
+	}
+
+	PipelineLibrary::Handle PipelineLibrary::Find(const GraphicsPipelineDesc& p_desc) const
+	{
+		const Table* table = m_table.load(std::memory_order_acquire);
+		assert(table && "pipeline library has been destroyed");
+
+		const GraphicsPipelineKey key = p_desc.GetKey();
+		const Entry* entry = Lookup(*table, ToSlotHash(key.GetHash()), key);
+		return entry ? Handle(*entry) : Handle();
+	}
+
+	size_t PipelineLibrary::GetPipelineCount() const
+	{
+		std::scoped_lock lock(m_writeMutex);
+		return m_entries.size();
+	}
+
+	std::pair<PipelineLibrary::Entry*, bool> PipelineLibrary::Claim(GraphicsPipelineKey&& p_key)
+	{
+		const uint64_t slotHash = ToSlotHash(p_key.GetHash());
+
+		if (Entry* entry = Lookup(*m_table.load(std::memory_order_acquire), slotHash, p_key))
+		{
+			return { entry, false };
+		}
+
+		std::scoped_lock lock(m_writeMutex);
+
+		Table* table = m_table.load(std::memory_order_relaxed);
+
+		if (Entry* entry = Lookup(*table, slotHash, p_key))
+		{
+			return { entry, false };
+		}
+
+		// Keep the load factor under 1/2, so probe sequences stay short
+		if ((m_entries.size() + 1) * 2 > table->size())
+		{
+			auto grownTable = std::make_unique<Table>(table->size() * 2);
+
+			for (const Slot& slot : *table)
+			{
+				if (const uint64_t slotHash = slot.hash.load(std::memory_order_relaxed))
+				{
+					Insert(*grownTable, slotHash, slot.entry.load(std::memory_order_relaxed));
+				}
+			}
+
+			table = grownTable.get();
+			m_tables.push_back(std::move(grownTable));
+			m_table.store(table, std::memory_order_release);
+		}
+
+		// The entry is published while pending, so concurrent requests for the same pipeline don't compile it twice
+		Entry* entry = m_entries.emplace_back(std::make_unique<Entry>()).get();
+		entry->key = std::move(p_key);
+		Insert(*table, slotHash, entry);
+
+		return { entry, true };
+	}
+
+	void PipelineLibrary::Compile(Entry& p_entry, const GraphicsPipelineDesc& p_desc)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		try
+		{
+			if (m_useGraphicsPipelineLibraries)
+			{
+				using enum EGraphicsPipelinePart;
+
+				const auto parts = std::to_array({
+					std::cref(GetOrCreatePart(VertexInput, p_desc)),
+					std::cref(GetOrCreatePart(PreRasterization, p_desc)),
+					std::cref(GetOrCreatePart(FragmentShader, p_desc)),
+					std::cref(GetOrCreatePart(FragmentOutput, p_desc))
+				});
+
+				p_entry.pipeline = std::make_unique<GraphicsPipeline>(m_device, p_desc, parts);
+			}
+			else
+			{
+				p_entry.pipeline = std::make_unique<GraphicsPipeline>(m_device, p_desc);
+			}
+
+			p_entry.state.store(EPipelineState::Ready, std::memory_order_release);
+		}
+		catch (...)
+		{
+			p_entry.state.store(EPipelineState::Failed, std::memory_order_release);
+			p_entry.state.notify_all();
+			throw;
+		}
+
+		p_entry.state.notify_all();
+
+		// The fast-linked pipeline can be used right away, while an optimized one is linked in the background
+		if (m_optimizeInBackground && !p_entry.pipeline->IsOptimized())
+		{
+			m_compileThreads->Enqueue([pipeline = p_entry.pipeline.get()] {
+				pipeline->Optimize();
+			});
+		}
+	}
+
+	const GraphicsPipelinePart& PipelineLibrary::GetOrCreatePart(EGraphicsPipelinePart p_part, const GraphicsPipelineDesc& p_desc)
+	{
+		PartEntry* entry = nullptr;
+
+		{
+			std::scoped_lock lock(m_partsMutex);
+
+			auto& partEntry = m_parts[GraphicsPipelinePart::GetKey(p_part, p_desc)];
+			if (!partEntry)
+			{
+				partEntry = std::make_unique<PartEntry>();
+			}
+
+			entry = partEntry.get();
+		}
+
+		// Compiled outside of the lock, concurrent requests for the same part wait for a single compilation
+		// (if it throws, the next request tries again)
+		std::call_once(entry->compiled, [&] {
+			entry->part = std::make_unique<GraphicsPipelinePart>(m_device, p_part, p_desc);
+		});
+
+		return *entry->part;
+	}
+
+	size_t PipelineLibrary::KeyHash::operator()(const GraphicsPipelineKey& p_key) const
+	{
+		return static_cast<size_t>(p_key.GetHash());
+	}
+
+	uint64_t PipelineLibrary::ToSlotHash(uint64_t p_hash)
+	{
+		// 0 is reserved for empty slots. Sharing a slot hash with 1 is harmless, since keys are compared anyway.
+		return p_hash != 0 ? p_hash : 1;
+	}
+
+	PipelineLibrary::Entry* PipelineLibrary::Lookup(const Table& p_table, uint64_t p_slotHash, const GraphicsPipelineKey& p_key)
+	{
+		const size_t mask = p_table.size() - 1;
+
+		// Colliding hashes are stored in successive slots, so probing continues until the key matches
+		for (size_t i = p_slotHash & mask;; i = (i + 1) & mask)
+		{
+			const uint64_t slotHash = p_table[i].hash.load(std::memory_order_acquire);
+
+			if (slotHash == 0)
+			{
+				return nullptr;
+			}
+
+			if (slotHash == p_slotHash)
+			{
+				Entry* entry = p_table[i].entry.load(std::memory_order_relaxed);
+
+				if (entry->key == p_key)
+				{
+					return entry;
+				}
+			}
+		}
+	}
+
+	void PipelineLibrary::Insert(Table& p_table, uint64_t p_slotHash, Entry* p_entry)
+	{
+		const size_t mask = p_table.size() - 1;
+
+		size_t i = p_slotHash & mask;
+		while (p_table[i].hash.load(std::memory_order_relaxed) != 0)
+		{
+			i = (i + 1) & mask;
+		}
+
+		// The entry (and its key) is published before the hash, so a reader matching the hash always sees the entry
+		p_table[i].entry.store(p_entry, std::memory_order_relaxed);
+		p_table[i].hash.store(p_slotHash, std::memory_order_release);
+	}
+}
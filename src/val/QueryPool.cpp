@@ -0,0 +1,157 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/QueryPool.h>
+#include <val/Device.h>
+#include <val/utils/CpuProfiler.h>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
+namespace val
+{
+	QueryPool::QueryPool(Device& p_device, const QueryPoolDesc& p_desc) :
+		m_device(p_device),
+		m_desc(p_desc)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		VkQueryPoolCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.queryType = p_desc.type,
+			.queryCount = p_desc.count,
+			.pipelineStatistics = p_desc.pipelineStatistics
+		};
+
+		assert((p_desc.type != VK_QUERY_TYPE_PIPELINE_STATISTICS || p_desc.pipelineStatistics != 0) && "no pipeline statistics requested");
+
+		if (vkCreateQueryPool(
+			m_device.GetLogicalDevice(),
+			&createInfo,
+			nullptr,
+			&m_handle
+		) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create query pool!");
+		}
+
+		// Queries are created in an undefined state
+		Reset();
+	}
+
+	QueryPool::~QueryPool()
+	{
+		vkDestroyQueryPool(m_device.GetLogicalDevice(), m_handle, nullptr);
+	}
+
+	void QueryPool::Reset(uint32_t p_firstQuery, uint32_t p_queryCount)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_firstQuery + p_queryCount <= m_desc.count);
+		vkResetQueryPool(m_device.GetLogicalDevice(), m_handle, p_firstQuery, p_queryCount);
+	}
+
+	void QueryPool::Reset()
+	{
+		Reset(0, m_desc.count);
+	}
+
+	bool QueryPool::GetResults(
+		uint32_t p_firstQuery,
+		uint32_t p_queryCount,
+		std::span<uint64_t> p_results,
+		VkQueryResultFlags p_flags
+	) const
+	{
+		assert(p_firstQuery + p_queryCount <= m_desc.count);
+		assert(p_queryCount > 0 && p_results.size() >= p_queryCount && p_results.size() % p_queryCount == 0);
+
+		const VkResult result = vkGetQueryPoolResults(
+			m_device.GetLogicalDevice(),
+			m_handle,
+			p_firstQuery,
+			p_queryCount,
+			p_results.size_bytes(),
+			p_results.data(),
+			(p_results.size() / p_queryCount) * sizeof(uint64_t),
+			p_flags | VK_QUERY_RESULT_64_BIT
+		);
+
+		if (result != VK_SUCCESS && result != VK_NOT_READY)
+		{
+			throw std::runtime_error("failed to retrieve query pool results!");
+		}
+
+		return result == VK_SUCCESS;
+	}
+
+	std::optional<PipelineStatistics> QueryPool::GetPipelineStatistics(uint32_t p_query) const
+	{
+		assert(m_desc.type == VK_QUERY_TYPE_PIPELINE_STATISTICS);
+
+		// One value per enabled counter, ordered by increasing bit
+		std::vector<uint64_t> values(GetValueCountPerQuery());
+		if (!GetResults(p_query, 1, values))
+		{
+			return std::nullopt;
+		}
+
+		PipelineStatistics statistics;
+		VkQueryPipelineStatisticFlags remainingFlags = m_desc.pipelineStatistics;
+
+		for (const uint64_t value : values)
+		{
+			const VkQueryPipelineStatisticFlags flag = remainingFlags & (~remainingFlags + 1); // Lowest bit set
+			remainingFlags &= ~flag;
+
+			switch (flag)
+			{
+			case VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT: statistics.inputAssemblyVertices = value; break;
+			case VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT: statistics.inputAssemblyPrimitives = value; break;
+			case VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT: statistics.vertexShaderInvocations = value; break;
+			case VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT: statistics.clippingInvocations = value; break;
+			case VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT: statistics.clippingPrimitives = value; break;
+			case VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT: statistics.fragmentShaderInvocations = value; break;
+			case VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT: statistics.computeShaderInvocations = value; break;
+			default: break; // Counters without a dedicated field (geometry, tessellation) are skipped
+			}
+		}
+
+		return statistics;
+	}
+
+	std::optional<uint64_t> QueryPool::GetOcclusionResult(uint32_t p_query) const
+	{
+		assert(m_desc.type == VK_QUERY_TYPE_OCCLUSION);
+
+		uint64_t samplesPassed = 0;
+		if (!GetResults(p_query, 1, { &samplesPassed, 1 }))
+		{
+			return std::nullopt;
+		}
+
+		return samplesPassed;
+	}
+
+	uint32_t QueryPool::GetValueCountPerQuery() const
+	{
+		return m_desc.type == VK_QUERY_TYPE_PIPELINE_STATISTICS ?
+			static_cast<uint32_t>(std::popcount(m_desc.pipelineStatistics)) :
+			1;
+	}
+
+	const QueryPoolDesc& QueryPool::GetDesc() const
+	{
+		return m_desc;
+	}
+
+	VkQueryPool QueryPool::GetHandle() const
+	{
+		return m_handle;
+	}
+}
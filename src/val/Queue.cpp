@@ -6,7 +6,9 @@
 
 #include <val/Queue.h>
 #include <val/SwapChain.h>
+#include <val/SubmissionService.h>
 #include <val/utils/MemoryUtils.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -14,57 +16,168 @@
 
 namespace val
 {
-	Queue::Queue(VkDevice p_device, VkQueue p_queue) :
+	Queue::Queue(VkDevice p_device, VkQueue p_queue, GpuReactor& p_reactor) :
 		m_device(p_device),
-		m_handle(p_queue)
+		m_handle(p_queue),
+		m_reactor(p_reactor),
+		m_timeline(p_device)
 	{
 	}
 
-	void Queue::Submit(
+	GpuFuture Queue::Submit(
 		std::initializer_list<std::reference_wrapper<val::CommandBuffer>> p_commandBuffers,
 		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
 		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
 		std::optional<std::reference_wrapper<sync::Fence>> p_fence
 	)
 	{
-		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		const auto waitSemaphores = utils::MemoryUtils::PrepareArray<VkSemaphore>(p_waitSemaphores);
-		const auto signalSemaphores = utils::MemoryUtils::PrepareArray<VkSemaphore>(p_signalSemaphores);
-		const auto commandBuffers = utils::MemoryUtils::PrepareArray<VkCommandBuffer>(p_commandBuffers);
+		return Submit(
+			std::span<const std::reference_wrapper<val::CommandBuffer>>(p_commandBuffers.begin(), p_commandBuffers.end()),
+			p_waitSemaphores,
+			p_signalSemaphores,
+			p_fence
+		);
+	}
 
-		VkSubmitInfo submitInfo{
-			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
-			.pWaitSemaphores = waitSemaphores.data(),
-			.pWaitDstStageMask = waitStages,
-			.commandBufferCount = static_cast<uint32_t>(commandBuffers.size()),
-			.pCommandBuffers = commandBuffers.data(),
-			.signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()),
-			.pSignalSemaphores = signalSemaphores.data()
-		};
+	GpuFuture Queue::Submit(
+		std::span<const std::reference_wrapper<val::CommandBuffer>> p_commandBuffers,
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
+		std::optional<std::reference_wrapper<sync::Fence>> p_fence
+	)
+	{
+		return Submit(p_commandBuffers, p_waitSemaphores, p_signalSemaphores, {}, {}, p_fence);
+	}
+
+	GpuFuture Queue::Submit(
+		std::span<const std::reference_wrapper<val::CommandBuffer>> p_commandBuffers,
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
+		std::initializer_list<sync::TimelineValue> p_waitValues,
+		std::initializer_list<sync::TimelineValue> p_signalValues,
+		std::optional<std::reference_wrapper<sync::Fence>> p_fence
+	)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		SubmitBatch batch;
+
+		// Binary semaphores are waited when writing color attachments (e.g. swap chain image acquisition)
+		for (const auto& semaphore : p_waitSemaphores)
+		{
+			batch.Wait(semaphore.get(), VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+		}
+
+		for (const auto& value : p_waitValues)
+		{
+			batch.Wait(value, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+		}
 
-		if (vkQueueSubmit(
+		for (const auto& commandBuffer : p_commandBuffers)
+		{
+			batch.AddCommandBuffer(commandBuffer.get());
+		}
+
+		for (const auto& semaphore : p_signalSemaphores)
+		{
+			batch.Signal(semaphore.get());
+		}
+
+		for (const auto& value : p_signalValues)
+		{
+			batch.Signal(value);
+		}
+
+		return Submit(batch, p_fence);
+	}
+
+	GpuFuture Queue::Submit(
+		const SubmitBatch& p_batch,
+		std::optional<std::reference_wrapper<sync::Fence>> p_fence
+	)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		if (IsForwarded())
+		{
+			return m_service->Submit(p_batch, p_fence).get();
+		}
+
+		std::vector<VkSubmitInfo2> submitInfos = p_batch.GetSubmitInfos();
+
+		if (submitInfos.empty())
+		{
+			submitInfos.push_back(VkSubmitInfo2{ .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2 });
+		}
+
+		// The last submission also signals the queue timeline, which completes the returned future
+		VkSubmitInfo2& lastSubmitInfo = submitInfos.back();
+
+		std::vector<VkSemaphoreSubmitInfo> lastSignalSemaphores(
+			lastSubmitInfo.pSignalSemaphoreInfos,
+			lastSubmitInfo.pSignalSemaphoreInfos + lastSubmitInfo.signalSemaphoreInfoCount
+		);
+
+		const sync::TimelineValue completionValue{ m_timeline, m_lastSubmissionValue + 1 };
+
+		lastSignalSemaphores.push_back(VkSemaphoreSubmitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = m_timeline.GetHandle(),
+			.value = completionValue.value,
+			.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+		});
+
+		lastSubmitInfo.signalSemaphoreInfoCount = static_cast<uint32_t>(lastSignalSemaphores.size());
+		lastSubmitInfo.pSignalSemaphoreInfos = lastSignalSemaphores.data();
+
+		if (vkQueueSubmit2(
 			m_handle,
-			1,
-			&submitInfo,
+			static_cast<uint32_t>(submitInfos.size()),
+			submitInfos.data(),
 			p_fence.has_value() ? p_fence.value().get().GetHandle() : VK_NULL_HANDLE
 		) != VK_SUCCESS)
 		{
 			throw std::runtime_error("failed to submit queue!");
 		}
+
+		++m_lastSubmissionValue;
+
+		return GpuFuture(completionValue, m_reactor);
 	}
 
 	void Queue::Present(
 		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
 		val::SwapChain& p_swapChain,
-		uint32_t p_swapChainIndice
+		uint32_t p_swapChainIndice,
+		std::optional<std::reference_wrapper<sync::Fence>> p_fence
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
+		if (IsForwarded())
+		{
+			// Waited for, so the arguments outlive the task. Presented again from the submission thread.
+			m_service->Execute([&](Queue& p_queue) {
+				p_queue.Present(p_waitSemaphores, p_swapChain, p_swapChainIndice, p_fence);
+			}).get();
+
+			return;
+		}
+
 		const auto waitSemaphores = utils::MemoryUtils::PrepareArray<VkSemaphore>(p_waitSemaphores);
 		const auto swapChainHandle = p_swapChain.GetHandle();
 
+		const VkFence fenceHandle = p_fence.has_value() ? p_fence.value().get().GetHandle() : VK_NULL_HANDLE;
+
+		VkSwapchainPresentFenceInfoEXT presentFenceInfo{
+			.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT,
+			.swapchainCount = 1,
+			.pFences = &fenceHandle
+		};
+
 		VkPresentInfoKHR presentInfo{
 			.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+			.pNext = p_fence.has_value() ? &presentFenceInfo : nullptr,
 			.waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
 			.pWaitSemaphores = waitSemaphores.data(),
 			.swapchainCount = 1,
@@ -73,9 +186,9 @@ namespace val
 			.pResults = nullptr // (optional) allows to specify an array of VkResult values to check for every individual swap chain if presentation was successful. 
 		};
 
-		// Note: there is an error with our semaphores that can be addressed with:
+		// Presentation doesn't signal anything the application can wait for, so wait semaphores can only be reused
+		// once the present fence is signaled, or the queue is idle (see FrameScheduler).
 		// https://docs.vulkan.org/guide/latest/swapchain_semaphore_reuse.html
-		// It seems like the debug validation layer didn't use to pick up this error when vulkan-tutorial was written.
 		VkResult result = vkQueuePresentKHR(m_handle, &presentInfo);
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR)
@@ -89,8 +202,29 @@ namespace val
 		}
 	}
 
+	void Queue::WaitIdle()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		if (IsForwarded())
+		{
+			m_service->Execute([](Queue& p_queue) { p_queue.WaitIdle(); }).get();
+			return;
+		}
+
+		if (vkQueueWaitIdle(m_handle) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to wait for queue to be idle!");
+		}
+	}
+
 	VkQueue Queue::GetHandle() const
 	{
 		return m_handle;
 	}
+
+	bool Queue::IsForwarded() const
+	{
+		return m_service && !m_service->IsSubmissionThread();
+	}
 }
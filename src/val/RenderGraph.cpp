@@ -0,0 +1,1030 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/RenderGraph.h>
+#include <val/CommandPool.h>
+#include <val/CommandBuffer.h>
+#include <val/Device.h>
+#include <val/utils/CpuProfiler.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <latch>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+	// Transient resources not used for this many compilations are released
+	constexpr uint32_t k_maxUnusedCompilations = 8;
+
+	bool IsCompatible(const val::BufferDesc& p_available, const val::BufferDesc& p_requested)
+	{
+		return
+			p_available.size == p_requested.size &&
+			(p_available.usage & p_requested.usage) == p_requested.usage;
+	}
+
+	bool IsCompatible(const val::ImageDesc& p_available, const val::ImageDesc& p_requested)
+	{
+		return
+			p_available.extent.width == p_requested.extent.width &&
+			p_available.extent.height == p_requested.extent.height &&
+			p_available.extent.depth == p_requested.extent.depth &&
+			p_available.format == p_requested.format &&
+			p_available.aspectMask == p_requested.aspectMask &&
+			p_available.mipLevels == p_requested.mipLevels &&
+			p_available.arrayLayers == p_requested.arrayLayers &&
+			(p_available.usage & p_requested.usage) == p_requested.usage;
+	}
+
+	/**
+	* Returns a transient resource compatible with the given desc, available from the given level,
+	* creating a new one if none can be reused
+	*/
+	template<class T, class Desc, class Pool>
+	T& AcquireTransient(
+		val::Device& p_device,
+		Pool& p_pool,
+		const Desc& p_desc,
+		uint32_t p_firstLevel,
+		uint32_t p_lastLevel,
+		const val::Queue* p_queue
+	)
+	{
+		// Levels only order passes of the same queue, so a resource already used by this compilation can only
+		// be reused by passes of the queue that used it (a null queue means several queues are involved)
+		auto found = std::find_if(p_pool.begin(), p_pool.end(), [&](const auto& p_transient) {
+			const bool isSameQueue = p_queue && p_transient.queue == p_queue;
+			return
+				(p_transient.availableFrom == 0 || (p_transient.availableFrom <= p_firstLevel && isSameQueue)) &&
+				IsCompatible(p_transient.desc, p_desc);
+		});
+
+		if (found == p_pool.end())
+		{
+			auto& transient = p_pool.emplace_back(typename Pool::value_type{
+				.resource = std::make_unique<T>(p_device, p_desc),
+				.desc = p_desc
+			});
+
+			transient.resource->Allocate(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			found = std::prev(p_pool.end());
+		}
+
+		// Barriers are emitted at the beginning of each level, so the next user of this resource
+		// must belong to a later level than its last user.
+		found->availableFrom = p_lastLevel + 1;
+		found->unusedCompilations = 0;
+		found->queue = p_queue;
+		return *found->resource;
+	}
+
+	template<class Pool>
+	void ReleaseUnusedTransients(Pool& p_pool)
+	{
+		std::erase_if(p_pool, [](const auto& p_transient) {
+			return p_transient.unusedCompilations > k_maxUnusedCompilations;
+		});
+	}
+}
+
+namespace val
+{
+	RenderGraphPassBuilder::RenderGraphPassBuilder(RenderGraph& p_graph, uint32_t p_passIndex) :
+		m_graph(p_graph),
+		m_passIndex(p_passIndex)
+	{
+	}
+
+	RenderGraphResource RenderGraphPassBuilder::CreateBuffer(const BufferDesc& p_desc)
+	{
+		return m_graph.AddResource({ .transientBufferDesc = p_desc });
+	}
+
+	RenderGraphResource RenderGraphPassBuilder::CreateImage(const ImageDesc& p_desc)
+	{
+		return m_graph.AddResource({ .transientImageDesc = p_desc });
+	}
+
+	void RenderGraphPassBuilder::Read(RenderGraphResource p_resource, const sync::ResourceState& p_state)
+	{
+		assert(p_resource < m_graph.m_resources.size() && "invalid render graph resource");
+		m_graph.m_passes[m_passIndex].accesses.push_back({ p_resource, p_state, false });
+	}
+
+	void RenderGraphPassBuilder::Write(RenderGraphResource p_resource, const sync::ResourceState& p_state)
+	{
+		assert(p_resource < m_graph.m_resources.size() && "invalid render graph resource");
+		m_graph.m_passes[m_passIndex].accesses.push_back({ p_resource, p_state, true });
+	}
+
+	void RenderGraphPassBuilder::SetSideEffect()
+	{
+		m_graph.m_passes[m_passIndex].sideEffect = true;
+	}
+
+	RenderGraph::RenderGraph(Device& p_device, uint32_t p_recordingThreadCount) :
+		m_device(p_device),
+		m_recordingThreadCount(p_recordingThreadCount)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		if (m_recordingThreadCount == 0)
+		{
+			m_recordingThreadCount = std::max(1U, std::thread::hardware_concurrency());
+		}
+
+		// The calling thread records too, so it doesn't need a worker
+		if (m_recordingThreadCount > 1)
+		{
+			m_recordingThreads = std::make_unique<utils::ThreadPool>(m_recordingThreadCount - 1);
+		}
+	}
+
+	RenderGraph::~RenderGraph()
+	{
+	}
+
+	RenderGraphResource RenderGraph::ImportBuffer(Buffer& p_buffer)
+	{
+		assert(std::none_of(m_resources.begin(), m_resources.end(), [&](const auto& p_node) { return p_node.buffer == &p_buffer; }) && "buffer already imported");
+		return AddResource({ .buffer = &p_buffer });
+	}
+
+	RenderGraphResource RenderGraph::ImportImage(Image& p_image)
+	{
+		assert(std::none_of(m_resources.begin(), m_resources.end(), [&](const auto& p_node) { return p_node.image == &p_image; }) && "image already imported");
+		return AddResource({ .image = &p_image });
+	}
+
+	void RenderGraph::MarkAsOutput(RenderGraphResource p_resource, std::optional<sync::ResourceState> p_finalState)
+	{
+		assert(p_resource < m_resources.size() && "invalid render graph resource");
+
+		ResourceNode& node = m_resources[p_resource];
+		node.output = true;
+		node.finalState = p_finalState;
+		m_compiled = false;
+	}
+
+	void RenderGraph::AddPass(
+		std::string_view p_name,
+		EQueueType p_queueType,
+		const SetupCallback& p_setup,
+		ExecuteCallback p_execute
+	)
+	{
+		m_passes.push_back(PassNode{
+			.name = std::string(p_name),
+			.queueType = p_queueType,
+			.queue = &GetQueue(p_queueType),
+			.queueFamilyIndex = m_device.GetQueueFamilyIndex(p_queueType),
+			.execute = std::move(p_execute)
+		});
+
+		RenderGraphPassBuilder builder(*this, static_cast<uint32_t>(m_passes.size() - 1));
+		p_setup(builder);
+
+		m_compiled = false;
+	}
+
+	void RenderGraph::Compile()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::vector<bool> alive(m_passes.size());
+		CullPasses(alive);
+		SortPasses(alive);
+		AssignTransientResources();
+		ComputeBarriers();
+		m_compiled = true;
+	}
+
+	GpuFuture RenderGraph::Execute(
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
+		std::optional<std::reference_wrapper<sync::Fence>> p_fence
+	)
+	{
+		return Execute(p_waitSemaphores, p_signalSemaphores, {}, {}, p_fence);
+	}
+
+	GpuFuture RenderGraph::Execute(
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
+		std::initializer_list<sync::TimelineValue> p_waitValues,
+		std::initializer_list<sync::TimelineValue> p_signalValues,
+		std::optional<std::reference_wrapper<sync::Fence>> p_fence
+	)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(m_compiled && "the render graph must be compiled before being executed");
+
+		const uint32_t passCount = static_cast<uint32_t>(m_executionOrder.size());
+		const uint32_t workerCount = std::max(1U, std::min(m_recordingThreadCount, passCount));
+
+		// Command pools can't be used from multiple threads, so each worker gets its own
+		if (m_workers.size() < workerCount)
+		{
+			m_workers.resize(workerCount);
+		}
+
+		for (auto& worker : m_workers)
+		{
+			for (auto& [queueType, pool] : worker.pools)
+			{
+				pool.usedCommandBuffers = 0;
+			}
+		}
+
+		std::vector<CommandBuffer*> recordedCommandBuffers(passCount);
+		std::vector<std::exception_ptr> errors(workerCount);
+		std::atomic<uint32_t> nextPosition = 0;
+
+		auto record = [&](uint32_t p_workerIndex) {
+			try
+			{
+				for (uint32_t position = nextPosition++; position < passCount; position = nextPosition++)
+				{
+					const PassNode& pass = m_passes[m_executionOrder[position]];
+					CommandBuffer& commandBuffer = AcquireCommandBuffer(m_workers[p_workerIndex], pass.queueType);
+					RecordPass(position, commandBuffer);
+					recordedCommandBuffers[position] = &commandBuffer;
+				}
+			}
+			catch (...)
+			{
+				errors[p_workerIndex] = std::current_exception();
+			}
+		};
+
+		{
+			std::latch recorded(workerCount - 1);
+
+			for (uint32_t i = 1; i < workerCount; ++i)
+			{
+				m_recordingThreads->Enqueue([&record, &recorded, i] {
+					record(i);
+					recorded.count_down();
+				});
+			}
+
+			// The calling thread records too
+			record(0);
+			recorded.wait();
+		}
+
+		for (const auto& error : errors)
+		{
+			if (error)
+			{
+				std::rethrow_exception(error);
+			}
+		}
+
+		GpuFuture future = SubmitToQueues(
+			recordedCommandBuffers,
+			p_waitSemaphores,
+			p_signalSemaphores,
+			p_waitValues,
+			p_signalValues,
+			p_fence
+		);
+
+		// Command buffers recorded by the graph don't track resource states, so we commit the states
+		// simulated during the compilation.
+		for (const auto& node : m_resources)
+		{
+			if (!node.firstLevel.has_value())
+			{
+				continue;
+			}
+
+			if (node.buffer)
+			{
+				node.buffer->SetState(m_simulatedBufferStates.at(node.buffer));
+			}
+			else if (node.image)
+			{
+				node.image->SetState(m_simulatedImageStates.at(node.image));
+			}
+		}
+
+		m_compiled = false;
+
+		return future;
+	}
+
+	void RenderGraph::Reset()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		m_passes.clear();
+		m_resources.clear();
+		m_executionOrder.clear();
+		m_queues.clear();
+		m_barriers.clear();
+		m_releaseBarriers.clear();
+		m_crossQueueWaits.clear();
+		m_crossQueueSignals.clear();
+		m_prologueBarriers.Clear();
+		m_finalBarriers.Clear();
+		m_simulatedBufferStates.clear();
+		m_simulatedImageStates.clear();
+		m_compiled = false;
+	}
+
+	Buffer& RenderGraph::GetBuffer(RenderGraphResource p_resource) const
+	{
+		assert(p_resource < m_resources.size() && "invalid render graph resource");
+		assert(m_resources[p_resource].buffer && "resource isn't a buffer, or hasn't been assigned yet");
+		return *m_resources[p_resource].buffer;
+	}
+
+	Image& RenderGraph::GetImage(RenderGraphResource p_resource) const
+	{
+		assert(p_resource < m_resources.size() && "invalid render graph resource");
+		assert(m_resources[p_resource].image && "resource isn't an image, or hasn't been assigned yet");
+		return *m_resources[p_resource].image;
+	}
+
+	std::vector<std::string_view> RenderGraph::GetExecutionOrder() const
+	{
+		assert(m_compiled && "the render graph must be compiled first");
+
+		std::vector<std::string_view> output;
+		output.reserve(m_executionOrder.size());
+
+		for (const auto passIndex : m_executionOrder)
+		{
+			output.push_back(m_passes[passIndex].name);
+		}
+
+		return output;
+	}
+
+	RenderGraphResource RenderGraph::AddResource(ResourceNode&& p_node)
+	{
+		m_resources.push_back(std::move(p_node));
+		m_compiled = false;
+		return static_cast<RenderGraphResource>(m_resources.size() - 1);
+	}
+
+	void RenderGraph::CullPasses(std::vector<bool>& p_alive) const
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::vector<bool> neededResources(m_resources.size());
+
+		for (size_t i = 0; i < m_resources.size(); ++i)
+		{
+			neededResources[i] = m_resources[i].output;
+		}
+
+		// Walk the passes backward: a pass is needed if it writes a resource needed by a later pass
+		// (or by the graph outputs), in which case the resources it reads become needed too.
+		for (size_t i = m_passes.size(); i-- > 0;)
+		{
+			const PassNode& pass = m_passes[i];
+
+			p_alive[i] = pass.sideEffect || std::any_of(pass.accesses.begin(), pass.accesses.end(), [&](const ResourceAccess& p_access) {
+				return p_access.write && neededResources[p_access.resource];
+			});
+
+			if (p_alive[i])
+			{
+				for (const auto& access : pass.accesses)
+				{
+					if (!access.write)
+					{
+						neededResources[access.resource] = true;
+					}
+				}
+			}
+		}
+	}
+
+	void RenderGraph::SortPasses(const std::vector<bool>& p_alive)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		struct ResourceUsage
+		{
+			std::optional<uint32_t> lastWriter;
+			std::vector<uint32_t> readers;
+			std::optional<VkImageLayout> layout;
+			std::optional<uint32_t> queueFamilyIndex;
+		};
+
+		std::vector<ResourceUsage> usages(m_resources.size());
+		m_executionOrder.clear();
+
+		for (uint32_t i = 0; i < m_passes.size(); ++i)
+		{
+			if (!p_alive[i])
+			{
+				continue;
+			}
+
+			PassNode& pass = m_passes[i];
+			pass.level = 0;
+			pass.dependencies.clear();
+
+			auto dependsOn = [&](uint32_t p_otherPass) {
+				if (p_otherPass != i)
+				{
+					pass.level = std::max(pass.level, m_passes[p_otherPass].level + 1);
+					pass.dependencies.push_back(p_otherPass);
+				}
+			};
+
+			// A layout transition modifies the image, so it has to wait for the previous readers, like a write would.
+			// So does a queue family ownership transfer, since the previous family must be done with the resource.
+			auto isExclusive = [&](const ResourceAccess& p_access) {
+				const ResourceUsage& usage = usages[p_access.resource];
+				const bool isImage = m_resources[p_access.resource].image || m_resources[p_access.resource].transientImageDesc;
+				const bool isLayoutChange = isImage && usage.layout.has_value() && usage.layout.value() != p_access.state.layout;
+				const bool isOwnershipTransfer = usage.queueFamilyIndex.has_value() && usage.queueFamilyIndex.value() != pass.queueFamilyIndex;
+				return p_access.write || isLayoutChange || isOwnershipTransfer;
+			};
+
+			for (const auto& access : pass.accesses)
+			{
+				const ResourceUsage& usage = usages[access.resource];
+
+				if (usage.lastWriter.has_value())
+				{
+					dependsOn(usage.lastWriter.value());
+				}
+
+				if (isExclusive(access))
+				{
+					std::for_each(usage.readers.begin(), usage.readers.end(), dependsOn);
+				}
+			}
+
+			for (const auto& access : pass.accesses)
+			{
+				ResourceUsage& usage = usages[access.resource];
+
+				if (isExclusive(access))
+				{
+					usage.lastWriter = i;
+					usage.readers.clear();
+				}
+				else
+				{
+					usage.readers.push_back(i);
+				}
+
+				usage.layout = access.state.layout;
+				usage.queueFamilyIndex = pass.queueFamilyIndex;
+			}
+
+			std::sort(pass.dependencies.begin(), pass.dependencies.end());
+			pass.dependencies.erase(std::unique(pass.dependencies.begin(), pass.dependencies.end()), pass.dependencies.end());
+
+			m_executionOrder.push_back(i);
+		}
+
+		// Passes are grouped by dependency level, so every pass of a level only depends on passes of previous levels.
+		// Barriers can then be batched once per level. The sort is stable to preserve the declaration order within a level.
+		std::stable_sort(m_executionOrder.begin(), m_executionOrder.end(), [this](uint32_t p_lhs, uint32_t p_rhs) {
+			return m_passes[p_lhs].level < m_passes[p_rhs].level;
+		});
+	}
+
+	void RenderGraph::AssignTransientResources()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::vector<uint32_t> transientResources;
+
+		for (uint32_t i = 0; i < m_resources.size(); ++i)
+		{
+			ResourceNode& node = m_resources[i];
+			node.firstLevel.reset();
+			node.lastLevel = 0;
+			node.queue.reset();
+
+			if (node.transientBufferDesc || node.transientImageDesc)
+			{
+				node.buffer = nullptr;
+				node.image = nullptr;
+				transientResources.push_back(i);
+			}
+		}
+
+		for (const auto passIndex : m_executionOrder)
+		{
+			const PassNode& pass = m_passes[passIndex];
+
+			for (const auto& access : pass.accesses)
+			{
+				ResourceNode& node = m_resources[access.resource];
+				node.firstLevel = std::min(node.firstLevel.value_or(pass.level), pass.level);
+				node.lastLevel = std::max(node.lastLevel, pass.level);
+				node.queue = node.queue.value_or(pass.queue) == pass.queue ? pass.queue : nullptr;
+			}
+		}
+
+		// Transients are assigned by order of first use, so a resource whose lifetime ended can be reused by a later one
+		std::erase_if(transientResources, [this](uint32_t p_resource) {
+			return !m_resources[p_resource].firstLevel.has_value();
+		});
+
+		std::stable_sort(transientResources.begin(), transientResources.end(), [this](uint32_t p_lhs, uint32_t p_rhs) {
+			return m_resources[p_lhs].firstLevel.value() < m_resources[p_rhs].firstLevel.value();
+		});
+
+		for (auto& transient : m_transientBuffers)
+		{
+			transient.availableFrom = 0;
+			++transient.unusedCompilations;
+		}
+
+		for (auto& transient : m_transientImages)
+		{
+			transient.availableFrom = 0;
+			++transient.unusedCompilations;
+		}
+
+		for (const auto resource : transientResources)
+		{
+			ResourceNode& node = m_resources[resource];
+			const uint32_t firstLevel = node.firstLevel.value();
+
+			if (node.transientBufferDesc)
+			{
+				node.buffer = &AcquireTransient<Buffer>(m_device, m_transientBuffers, node.transientBufferDesc.value(), firstLevel, node.lastLevel, node.queue.value());
+			}
+			else
+			{
+				node.image = &AcquireTransient<Image>(m_device, m_transientImages, node.transientImageDesc.value(), firstLevel, node.lastLevel, node.queue.value());
+			}
+		}
+
+		ReleaseUnusedTransients(m_transientBuffers);
+		ReleaseUnusedTransients(m_transientImages);
+	}
+
+	void RenderGraph::ComputeBarriers()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const uint32_t graphicsFamily = m_device.GetQueueFamilyIndex(EQueueType::Graphics);
+
+		m_queues.assign(1, &GetQueue(EQueueType::Graphics));
+		m_barriers.clear();
+		m_barriers.resize(m_executionOrder.size());
+		m_releaseBarriers.clear();
+		m_releaseBarriers.resize(m_executionOrder.size());
+		m_crossQueueWaits.assign(m_executionOrder.size(), {});
+		m_crossQueueSignals.assign(m_executionOrder.size(), false);
+		m_prologueBarriers.Clear();
+		m_finalBarriers.Clear();
+		m_simulatedBufferStates.clear();
+		m_simulatedImageStates.clear();
+
+		// Returns the simulated state of a resource, initialized from its last known state on first use.
+		// Transient images start from an undefined layout, since their previous content is irrelevant.
+		auto getBufferState = [this](const ResourceNode& p_node) -> sync::ResourceState& {
+			auto [it, inserted] = m_simulatedBufferStates.try_emplace(p_node.buffer, p_node.buffer->GetState());
+			return it->second;
+		};
+
+		auto getImageState = [this](const ResourceNode& p_node, bool p_firstUse) -> sync::ResourceState& {
+			auto [it, inserted] = m_simulatedImageStates.try_emplace(p_node.image, p_node.image->GetState());
+
+			if (p_firstUse && p_node.transientImageDesc)
+			{
+				it->second.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			}
+
+			return it->second;
+		};
+
+		// Transfers a resource to another queue family: released after its last use by the current family
+		// (or before the graph for imported resources), and acquired in the given batch
+		auto transferOwnership = [&](
+			const ResourceNode& p_node,
+			sync::BarrierBatch& p_releaseBatch,
+			sync::BarrierBatch& p_acquireBatch,
+			const sync::ResourceState& p_targetState,
+			uint32_t p_srcFamily,
+			uint32_t p_dstFamily
+		) {
+			if (p_node.buffer)
+			{
+				sync::ResourceState& state = getBufferState(p_node);
+				sync::ResourceState releasedState{};
+				p_releaseBatch.AddBufferOwnershipTransfer(p_node.buffer->GetHandle(), state, releasedState, p_srcFamily, p_dstFamily);
+				p_acquireBatch.AddBufferOwnershipTransfer(p_node.buffer->GetHandle(), releasedState, p_targetState, p_srcFamily, p_dstFamily);
+				state = releasedState;
+			}
+			else
+			{
+				// The release and the acquire must describe the same layout transition
+				sync::ResourceState& state = getImageState(p_node, false);
+				sync::ResourceState releasedState{ .layout = state.layout };
+				p_releaseBatch.AddImageOwnershipTransfer(p_node.image->GetHandle(), state, { .layout = p_targetState.layout },
+					p_node.image->GetSubresourceRange(), p_srcFamily, p_dstFamily);
+				p_acquireBatch.AddImageOwnershipTransfer(p_node.image->GetHandle(), releasedState, p_targetState,
+					p_node.image->GetSubresourceRange(), p_srcFamily, p_dstFamily);
+				state = releasedState;
+			}
+		};
+
+		std::vector<uint32_t> positions(m_passes.size());
+		std::vector<bool> used(m_resources.size());
+		std::vector<std::optional<uint32_t>> owners(m_resources.size()); // Queue family owning each resource
+		std::vector<std::optional<uint32_t>> lastPositions(m_resources.size()); // Last pass using each resource
+		std::unordered_map<const Queue*, size_t> levelStarts;
+
+		for (uint32_t i = 0; i < m_resources.size(); ++i)
+		{
+			// Transient resources don't have an owner until their first use, since their previous content is discarded
+			if (!m_resources[i].transientBufferDesc && !m_resources[i].transientImageDesc)
+			{
+				owners[i] = graphicsFamily;
+			}
+		}
+
+		for (size_t position = 0; position < m_executionOrder.size(); ++position)
+		{
+			const uint32_t passIndex = m_executionOrder[position];
+			const PassNode& pass = m_passes[passIndex];
+			positions[passIndex] = static_cast<uint32_t>(position);
+
+			if (position > 0 && pass.level != m_passes[m_executionOrder[position - 1]].level)
+			{
+				levelStarts.clear();
+			}
+
+			if (std::find(m_queues.begin(), m_queues.end(), pass.queue) == m_queues.end())
+			{
+				m_queues.push_back(pass.queue);
+			}
+
+			// Barriers are batched per level and per queue, and recorded by the first pass of the level on that queue.
+			// This pass also waits for the other queues, on behalf of the passes of the level.
+			const size_t levelStart = levelStarts.try_emplace(pass.queue, position).first->second;
+			sync::BarrierBatch& batch = m_barriers[levelStart];
+
+			auto waitFor = [&](uint32_t p_otherPosition) {
+				if (m_passes[m_executionOrder[p_otherPosition]].queue != pass.queue)
+				{
+					m_crossQueueWaits[levelStart].push_back(p_otherPosition);
+					m_crossQueueSignals[p_otherPosition] = true;
+				}
+			};
+
+			for (const auto dependency : pass.dependencies)
+			{
+				waitFor(positions[dependency]);
+			}
+
+			for (const auto& access : pass.accesses)
+			{
+				const ResourceNode& node = m_resources[access.resource];
+				const bool firstUse = !used[access.resource];
+				used[access.resource] = true;
+
+				std::optional<uint32_t>& owner = owners[access.resource];
+				std::optional<uint32_t>& lastPosition = lastPositions[access.resource];
+
+				if (owner.has_value() && owner.value() != pass.queueFamilyIndex)
+				{
+					// Imported resources are released by a graphics prologue, waited for by the other queues.
+					// Later accesses to the resource in this batch extend the acquire (see BarrierBatch).
+					sync::BarrierBatch& releaseBatch = lastPosition.has_value() ? m_releaseBarriers[lastPosition.value()] : m_prologueBarriers;
+					transferOwnership(node, releaseBatch, batch, access.state, owner.value(), pass.queueFamilyIndex);
+
+					if (lastPosition.has_value())
+					{
+						waitFor(lastPosition.value());
+					}
+				}
+				else if (node.buffer)
+				{
+					batch.AddBufferTransition(node.buffer->GetHandle(), getBufferState(node), access.state);
+				}
+				else
+				{
+					batch.AddImageTransition(node.image->GetHandle(), getImageState(node, firstUse), access.state, node.image->GetSubresourceRange());
+				}
+
+				owner = pass.queueFamilyIndex;
+				lastPosition = static_cast<uint32_t>(position);
+			}
+		}
+
+		for (auto& waits : m_crossQueueWaits)
+		{
+			std::sort(waits.begin(), waits.end());
+			waits.erase(std::unique(waits.begin(), waits.end()), waits.end());
+		}
+
+		// Final barriers are recorded on the graphics queue, once every queue is done
+		for (uint32_t i = 0; i < m_resources.size(); ++i)
+		{
+			const ResourceNode& node = m_resources[i];
+
+			if (!node.firstLevel.has_value())
+			{
+				continue;
+			}
+
+			const bool isImported = !node.transientBufferDesc && !node.transientImageDesc;
+			const std::optional<uint32_t> owner = owners[i];
+
+			if (owner.has_value() && owner.value() != graphicsFamily && (isImported || node.finalState.has_value()))
+			{
+				const sync::ResourceState& state = node.buffer ? getBufferState(node) : getImageState(node, false);
+				const sync::ResourceState targetState = node.finalState.value_or(sync::ResourceState{
+					.stageMask = state.stageMask,
+					.accessMask = state.accessMask,
+					.layout = state.layout
+				});
+
+				transferOwnership(node, m_releaseBarriers[lastPositions[i].value()], m_finalBarriers, targetState, owner.value(), graphicsFamily);
+			}
+			else if (!node.finalState.has_value())
+			{
+				continue;
+			}
+			else if (node.buffer)
+			{
+				m_finalBarriers.AddBufferTransition(node.buffer->GetHandle(), getBufferState(node), node.finalState.value());
+			}
+			else
+			{
+				m_finalBarriers.AddImageTransition(node.image->GetHandle(), getImageState(node, false), node.finalState.value(), node.image->GetSubresourceRange());
+			}
+		}
+	}
+
+	void RenderGraph::RecordPass(uint32_t p_position, CommandBuffer& p_commandBuffer)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		const PassNode& pass = m_passes[m_executionOrder[p_position]];
+
+		// Barriers have been computed during the compilation
+		p_commandBuffer.SetResourceStateTracking(false);
+		p_commandBuffer.Reset();
+		p_commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+		m_barriers[p_position].Flush(p_commandBuffer.GetHandle());
+
+		pass.execute(p_commandBuffer);
+
+		m_releaseBarriers[p_position].Flush(p_commandBuffer.GetHandle());
+
+		// With several queues, final barriers are recorded once every queue is done (see SubmitToQueues)
+		if (m_queues.size() == 1 && p_position == m_executionOrder.size() - 1)
+		{
+			m_finalBarriers.Flush(p_commandBuffer.GetHandle());
+		}
+
+		p_commandBuffer.End();
+	}
+
+	CommandBuffer& RenderGraph::RecordBarriers(sync::BarrierBatch& p_barriers)
+	{
+		// Only called once the passes are recorded, so the first worker is available
+		CommandBuffer& commandBuffer = AcquireCommandBuffer(m_workers.front(), EQueueType::Graphics);
+
+		commandBuffer.SetResourceStateTracking(false);
+		commandBuffer.Reset();
+		commandBuffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		p_barriers.Flush(commandBuffer.GetHandle());
+		commandBuffer.End();
+
+		return commandBuffer;
+	}
+
+	GpuFuture RenderGraph::SubmitToQueues(
+		std::span<CommandBuffer* const> p_commandBuffers,
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_waitSemaphores,
+		std::initializer_list<std::reference_wrapper<val::sync::Semaphore>> p_signalSemaphores,
+		std::initializer_list<sync::TimelineValue> p_waitValues,
+		std::initializer_list<sync::TimelineValue> p_signalValues,
+		std::optional<std::reference_wrapper<sync::Fence>> p_fence
+	)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		Queue& graphicsQueue = *m_queues.front();
+
+		// A single queue doesn't need any cross-queue synchronization, so the whole graph is submitted at once
+		if (m_queues.size() == 1)
+		{
+			std::vector<std::reference_wrapper<CommandBuffer>> commandBuffers;
+			commandBuffers.reserve(p_commandBuffers.size());
+
+			for (auto commandBuffer : p_commandBuffers)
+			{
+				commandBuffers.push_back(*commandBuffer);
+			}
+
+			return graphicsQueue.Submit(
+				commandBuffers,
+				p_waitSemaphores,
+				p_signalSemaphores,
+				p_waitValues,
+				p_signalValues,
+				p_fence
+			);
+		}
+
+		struct QueueSubmissions
+		{
+			SubmitBatch batch;
+			bool hasCommandBuffers = false; // Waits added to the current submission would delay its command buffers
+			std::optional<sync::TimelineValue> signaledValue; // Signaled by the current submission, which is closed
+		};
+
+		std::vector<QueueSubmissions> submissions(m_queues.size());
+		std::vector<std::optional<sync::TimelineValue>> signaledValues(p_commandBuffers.size());
+
+		auto getSubmissions = [&](const Queue* p_queue) -> QueueSubmissions& {
+			return submissions[std::distance(m_queues.begin(), std::find(m_queues.begin(), m_queues.end(), p_queue))];
+		};
+
+		auto startSubmission = [](QueueSubmissions& p_submissions) {
+			p_submissions.batch.AddSubmission();
+			p_submissions.hasCommandBuffers = false;
+			p_submissions.signaledValue.reset();
+		};
+
+		auto signal = [this](const Queue& p_queue, QueueSubmissions& p_submissions) {
+			if (!p_submissions.signaledValue.has_value())
+			{
+				QueueTimeline& timeline = GetTimeline(p_queue);
+				p_submissions.signaledValue = sync::TimelineValue{ *timeline.semaphore, ++timeline.lastValue };
+				p_submissions.batch.Signal(p_submissions.signaledValue.value());
+			}
+
+			return p_submissions.signaledValue.value();
+		};
+
+		auto addCommandBuffer = [&](QueueSubmissions& p_submissions, CommandBuffer& p_commandBuffer) {
+			if (p_submissions.signaledValue.has_value())
+			{
+				startSubmission(p_submissions);
+			}
+
+			p_submissions.batch.AddCommandBuffer(p_commandBuffer);
+			p_submissions.hasCommandBuffers = true;
+		};
+
+		// Binary semaphores (e.g. swap chain image acquisition) are waited by the graphics queue, timeline values by every queue
+		for (const auto& semaphore : p_waitSemaphores)
+		{
+			submissions.front().batch.Wait(semaphore.get(), VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+		}
+
+		for (auto& queueSubmissions : submissions)
+		{
+			for (const auto& value : p_waitValues)
+			{
+				queueSubmissions.batch.Wait(value, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+			}
+		}
+
+		// Imported resources first used by another queue family are released by the graphics queue first
+		if (!m_prologueBarriers.IsEmpty())
+		{
+			addCommandBuffer(submissions.front(), RecordBarriers(m_prologueBarriers));
+			const sync::TimelineValue prologueValue = signal(graphicsQueue, submissions.front());
+
+			for (size_t i = 1; i < submissions.size(); ++i)
+			{
+				submissions[i].batch.Wait(prologueValue, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+			}
+		}
+
+		for (size_t position = 0; position < p_commandBuffers.size(); ++position)
+		{
+			const Queue& queue = *m_passes[m_executionOrder[position]].queue;
+			QueueSubmissions& queueSubmissions = getSubmissions(&queue);
+
+			if (!m_crossQueueWaits[position].empty())
+			{
+				// Waits apply to a whole submission, so they start a new one
+				if (queueSubmissions.hasCommandBuffers || queueSubmissions.signaledValue.has_value())
+				{
+					startSubmission(queueSubmissions);
+				}
+
+				// Values of a timeline increase with the position, so only the last one of each queue is waited for
+				std::unordered_map<VkSemaphore, sync::TimelineValue> waitValues;
+
+				for (const auto otherPosition : m_crossQueueWaits[position])
+				{
+					const sync::TimelineValue& value = signaledValues[otherPosition].value();
+					waitValues.insert_or_assign(value.semaphore.get().GetHandle(), value);
+				}
+
+				for (const auto& [handle, value] : waitValues)
+				{
+					queueSubmissions.batch.Wait(value, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+				}
+			}
+
+			addCommandBuffer(queueSubmissions, *p_commandBuffers[position]);
+
+			if (m_crossQueueSignals[position])
+			{
+				signaledValues[position] = signal(queue, queueSubmissions);
+			}
+		}
+
+		// The graphics queue joins every other queue, so the final barriers, the signaled semaphores, the fence
+		// and the returned future cover the whole graph
+		QueueSubmissions& graphicsSubmissions = submissions.front();
+
+		if (graphicsSubmissions.hasCommandBuffers || graphicsSubmissions.signaledValue.has_value())
+		{
+			startSubmission(graphicsSubmissions);
+		}
+
+		for (size_t i = 1; i < submissions.size(); ++i)
+		{
+			graphicsSubmissions.batch.Wait(signal(*m_queues[i], submissions[i]), VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
+		}
+
+		if (!m_finalBarriers.IsEmpty())
+		{
+			addCommandBuffer(graphicsSubmissions, RecordBarriers(m_finalBarriers));
+		}
+
+		for (const auto& semaphore : p_signalSemaphores)
+		{
+			graphicsSubmissions.batch.Signal(semaphore.get());
+		}
+
+		for (const auto& value : p_signalValues)
+		{
+			graphicsSubmissions.batch.Signal(value);
+		}
+
+		// Waits for timeline values don't require the signal to be submitted first, so queues are submitted in any order
+		for (size_t i = 1; i < submissions.size(); ++i)
+		{
+			m_queues[i]->Submit(submissions[i].batch);
+		}
+
+		return graphicsQueue.Submit(graphicsSubmissions.batch, p_fence);
+	}
+
+	CommandBuffer& RenderGraph::AcquireCommandBuffer(RecordingWorker& p_worker, EQueueType p_queueType)
+	{
+		RecordingPool& pool = p_worker.pools[p_queueType];
+
+		if (!pool.commandPool)
+		{
+			pool.commandPool = std::make_unique<CommandPool>(m_device, p_queueType);
+		}
+
+		if (pool.usedCommandBuffers == pool.commandBuffers.size())
+		{
+			pool.commandBuffers.push_back(pool.commandPool->AllocateCommandBuffers(1).front());
+		}
+
+		return pool.commandBuffers[pool.usedCommandBuffers++];
+	}
+
+	RenderGraph::QueueTimeline& RenderGraph::GetTimeline(const Queue& p_queue)
+	{
+		QueueTimeline& timeline = m_timelines[&p_queue];
+
+		// Each queue signals its own timeline, so values are signaled in increasing order
+		if (!timeline.semaphore)
+		{
+			timeline.semaphore = std::make_unique<sync::TimelineSemaphore>(m_device.GetLogicalDevice());
+		}
+
+		return timeline;
+	}
+
+	Queue& RenderGraph::GetQueue(EQueueType p_queueType) const
+	{
+		switch (p_queueType)
+		{
+		case EQueueType::Compute:
+			return m_device.GetComputeQueue();
+		case EQueueType::Transfer:
+			return m_device.GetTransferQueue();
+		default:
+			return m_device.GetGraphicsQueue();
+		}
+	}
+}
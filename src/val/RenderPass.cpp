@@ -5,6 +5,7 @@
 */
 
 #include <val/RenderPass.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -12,8 +13,11 @@
 namespace val
 {
 	RenderPass::RenderPass(VkDevice p_device, VkFormat p_format) :
-		m_device(p_device)
+		m_device(p_device),
+		m_format(p_format)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		VkAttachmentDescription colorAttachment{
 			.format = p_format,
 			.samples = VK_SAMPLE_COUNT_1_BIT,
@@ -77,4 +81,9 @@ namespace val
 	{
 		return m_handle;
 	}
+
+	VkFormat RenderPass::GetFormat() const
+	{
+		return m_format;
+	}
 }
@@ -5,6 +5,8 @@
 */
 
 #include <val/ShaderModule.h>
+#include <val/utils/HashUtils.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -12,8 +14,12 @@
 namespace val
 {
 	ShaderModule::ShaderModule(VkDevice p_device, const std::span<const std::byte> p_byteCode) :
-		m_device(p_device)
+		m_device(p_device),
+		m_byteCode(p_byteCode.begin(), p_byteCode.end()),
+		m_hash(utils::HashUtils::HashBytes(p_byteCode))
 	{
+		VAL_PROFILE_FUNCTION();
+
 		VkShaderModuleCreateInfo createInfo{
 			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
 			.codeSize = p_byteCode.size(),
@@ -40,4 +46,14 @@ namespace val
 	{
 		return m_handle;
 	}
+
+	uint64_t ShaderModule::GetHash() const
+	{
+		return m_hash;
+	}
+
+	std::span<const std::byte> ShaderModule::GetByteCode() const
+	{
+		return m_byteCode;
+	}
 }
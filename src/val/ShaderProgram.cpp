@@ -5,6 +5,8 @@
 */
 
 #include <val/ShaderProgram.h>
+#include <val/utils/HashUtils.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -13,16 +15,93 @@ namespace val
 {
 	ShaderProgram::ShaderProgram(std::initializer_list<const std::reference_wrapper<ShaderStage>> p_stages)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		m_assembledStages.reserve(p_stages.size());
+		m_entryPoints.reserve(p_stages.size());
+		m_specializationMapEntries.reserve(p_stages.size());
+		m_specializationData.reserve(p_stages.size());
+		m_specializationInfos.reserve(p_stages.size());
+		m_stageKeys.reserve(p_stages.size());
+
+		// Stages are deep-copied, so pipelines (possibly compiled on other threads) never read a stage
+		// being specialized again, and always match the hash they are stored under
 		for (auto& stage : p_stages)
 		{
-			m_assembledStages.push_back(stage.get().GetCreateInfo());
+			const VkPipelineShaderStageCreateInfo& createInfo = stage.get().GetCreateInfo();
+			const VkSpecializationInfo* specializationInfo = createInfo.pSpecializationInfo;
+
+			m_assembledStages.push_back(createInfo);
+			m_entryPoints.emplace_back(createInfo.pName);
+			m_stageKeys.push_back(std::make_shared<const ShaderStageKey>(stage.get().GetKey()));
+
+			if (specializationInfo)
+			{
+				const auto data = static_cast<const std::byte*>(specializationInfo->pData);
+				m_specializationMapEntries.emplace_back(specializationInfo->pMapEntries, specializationInfo->pMapEntries + specializationInfo->mapEntryCount);
+				m_specializationData.emplace_back(data, data + specializationInfo->dataSize);
+			}
+			else
+			{
+				m_specializationMapEntries.emplace_back();
+				m_specializationData.emplace_back();
+			}
+
+			m_specializationInfos.push_back({
+				.mapEntryCount = static_cast<uint32_t>(m_specializationMapEntries.back().size()),
+				.pMapEntries = m_specializationMapEntries.back().data(),
+				.dataSize = m_specializationData.back().size(),
+				.pData = m_specializationData.back().data()
+			});
 		}
+
+		// Pointers are only set once every storage is filled, since moving short strings invalidates their data
+		for (size_t i = 0; i < m_assembledStages.size(); ++i)
+		{
+			m_assembledStages[i].pName = m_entryPoints[i].c_str();
+			m_assembledStages[i].pSpecializationInfo = m_specializationMapEntries[i].empty() ? nullptr : &m_specializationInfos[i];
+		}
+
+		m_hash = GetHash(VK_SHADER_STAGE_ALL);
 	}
 
 	std::vector<VkPipelineShaderStageCreateInfo> ShaderProgram::GetAssembledStages()
 	{
-		
 		return m_assembledStages;
 	}
+
+	uint64_t ShaderProgram::GetHash() const
+	{
+		return m_hash;
+	}
+
+	uint64_t ShaderProgram::GetHash(VkShaderStageFlags p_stages) const
+	{
+		uint64_t hash = 0;
+
+		for (size_t i = 0; i < m_assembledStages.size(); ++i)
+		{
+			if (m_assembledStages[i].stage & p_stages)
+			{
+				utils::HashUtils::Combine(hash, m_stageKeys[i]->hash);
+			}
+		}
+
+		return hash;
+	}
+
+	std::vector<std::shared_ptr<const ShaderStageKey>> ShaderProgram::GetKeys(VkShaderStageFlags p_stages) const
+	{
+		std::vector<std::shared_ptr<const ShaderStageKey>> keys;
+
+		for (size_t i = 0; i < m_assembledStages.size(); ++i)
+		{
+			if (m_assembledStages[i].stage & p_stages)
+			{
+				keys.push_back(m_stageKeys[i]);
+			}
+		}
+
+		return keys;
+	}
 }
@@ -5,25 +5,100 @@
 */
 
 #include <val/ShaderStage.h>
+#include <val/utils/HashUtils.h>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
+#include <string_view>
 
 namespace val
 {
-	ShaderStage::ShaderStage(const ShaderModule& p_shaderModule, VkShaderStageFlagBits p_stage) :
+	ShaderStage::ShaderStage(const ShaderModule& p_shaderModule, VkShaderStageFlagBits p_stage, std::string p_entryPoint) :
+		m_byteCode(p_shaderModule.GetByteCode()),
+		m_moduleHash(p_shaderModule.GetHash()),
+		m_entryPoint(std::move(p_entryPoint)),
 		m_shaderStageCreateInfo{
 			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
 			.stage = p_stage,
-			.module = p_shaderModule.GetHandle(),
-			.pName = "main"
+			.module = p_shaderModule.GetHandle()
 		}
 	{
+		Update();
+	}
+
+	ShaderStage& ShaderStage::Specialize(uint32_t p_constantId, std::span<const std::byte> p_data)
+	{
+		auto it = std::find_if(m_specializationMapEntries.begin(), m_specializationMapEntries.end(), [p_constantId](const auto& p_entry) {
+			return p_entry.constantID == p_constantId;
+		});
 
+		// Specializing a constant again overwrites its value in place
+		if (it != m_specializationMapEntries.end())
+		{
+			assert(it->size == p_data.size() && "specialization constant specialized again with a different size");
+			std::copy(p_data.begin(), p_data.end(), m_specializationData.begin() + it->offset);
+		}
+		else
+		{
+			m_specializationMapEntries.push_back({
+				.constantID = p_constantId,
+				.offset = static_cast<uint32_t>(m_specializationData.size()),
+				.size = p_data.size()
+			});
+
+			m_specializationData.insert(m_specializationData.end(), p_data.begin(), p_data.end());
+		}
+
+		Update();
+
+		return *this;
 	}
 
 	const VkPipelineShaderStageCreateInfo& ShaderStage::GetCreateInfo() const
 	{
 		return m_shaderStageCreateInfo;
 	}
+
+	uint64_t ShaderStage::GetHash() const
+	{
+		return m_hash;
+	}
+
+	ShaderStageKey ShaderStage::GetKey() const
+	{
+		using utils::HashUtils;
+
+		ShaderStageKey key{ .hash = m_hash };
+
+		// Same content as the hash, with the byte code itself instead of its hash
+		HashUtils::AppendRange(key.bytes, m_byteCode);
+		HashUtils::Append(key.bytes, m_shaderStageCreateInfo.stage);
+		HashUtils::AppendRange(key.bytes, std::as_bytes(std::span{ std::string_view{ m_entryPoint } }));
+		HashUtils::AppendRange(key.bytes, std::span<const VkSpecializationMapEntry>(m_specializationMapEntries));
+		HashUtils::AppendRange(key.bytes, std::span<const std::byte>(m_specializationData));
+
+		return key;
+	}
+
+	void ShaderStage::Update()
+	{
+		// Storage may have been reallocated, so pointers are updated every time it changes
+		m_specializationInfo = {
+			.mapEntryCount = static_cast<uint32_t>(m_specializationMapEntries.size()),
+			.pMapEntries = m_specializationMapEntries.data(),
+			.dataSize = m_specializationData.size(),
+			.pData = m_specializationData.data()
+		};
+
+		m_shaderStageCreateInfo.pName = m_entryPoint.c_str();
+		m_shaderStageCreateInfo.pSpecializationInfo = m_specializationMapEntries.empty() ? nullptr : &m_specializationInfo;
+
+		// Constants are hashed in the order they were specialized: identical values set in a different order produce a different hash
+		m_hash = m_moduleHash;
+		utils::HashUtils::Combine(m_hash, m_shaderStageCreateInfo.stage);
+		m_hash = utils::HashUtils::HashBytes(std::as_bytes(std::span{ std::string_view{ m_entryPoint } }), m_hash);
+		utils::HashUtils::CombineRange(m_hash, std::span<const VkSpecializationMapEntry>(m_specializationMapEntries));
+		utils::HashUtils::CombineRange(m_hash, std::span<const std::byte>(m_specializationData));
+	}
 }
@@ -0,0 +1,172 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/SubmissionService.h>
+#include <val/utils/CpuProfiler.h>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace val
+{
+	SubmissionService::SubmissionService(Queue& p_queue) :
+		m_queue(p_queue)
+	{
+		assert(!m_queue.m_service && "a queue can only have one submission service");
+
+		m_thread = std::jthread([this] { Run(); });
+
+		// Set once the thread handle is known, since forwarding depends on the calling thread (requests are only
+		// pushed after this point, so the submission thread sees it)
+		m_queue.m_service = this;
+	}
+
+	SubmissionService::~SubmissionService()
+	{
+		// Pushed last, so every pending request is processed before the thread exits
+		Push(new Request{ .stop = true });
+		m_thread.join();
+
+		m_queue.m_service = nullptr;
+	}
+
+	std::future<GpuFuture> SubmissionService::Submit(SubmitBatch p_batch, std::optional<std::reference_wrapper<sync::Fence>> p_fence)
+	{
+		Request* request = new Request{
+			.batch = std::move(p_batch),
+			.fence = p_fence
+		};
+
+		std::future<GpuFuture> future = request->submitPromise.get_future();
+		Push(request);
+		return future;
+	}
+
+	std::future<void> SubmissionService::Execute(Task p_task)
+	{
+		Request* request = new Request{
+			.task = std::move(p_task)
+		};
+
+		std::future<void> future = request->taskPromise.get_future();
+		Push(request);
+		return future;
+	}
+
+	bool SubmissionService::IsSubmissionThread() const
+	{
+		return std::this_thread::get_id() == m_thread.get_id();
+	}
+
+	void SubmissionService::Push(Request* p_request)
+	{
+		// Lock-free push at the head of the list (Treiber stack)
+		Request* head = m_head.load(std::memory_order_relaxed);
+
+		do
+		{
+			p_request->next = head;
+		} while (!m_head.compare_exchange_weak(head, p_request, std::memory_order_release, std::memory_order_relaxed));
+
+		m_head.notify_one();
+	}
+
+	void SubmissionService::Run()
+	{
+		std::vector<std::unique_ptr<Request>> requests;
+		std::vector<Request*> pendingRequests;
+		SubmitBatch pendingBatch;
+
+		// Submits the batches merged so far, and resolves their futures
+		auto flush = [&](std::optional<std::reference_wrapper<sync::Fence>> p_fence) {
+			if (pendingRequests.empty())
+			{
+				return;
+			}
+
+			std::optional<GpuFuture> future;
+			std::exception_ptr error;
+
+			try
+			{
+				future.emplace(m_queue.Submit(pendingBatch, p_fence));
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			for (Request* request : pendingRequests)
+			{
+				if (error)
+				{
+					request->submitPromise.set_exception(error);
+				}
+				else
+				{
+					request->submitPromise.set_value(future.value());
+				}
+			}
+
+			pendingRequests.clear();
+			pendingBatch.Clear();
+		};
+
+		bool stop = false;
+
+		while (!stop)
+		{
+			m_head.wait(nullptr, std::memory_order_acquire);
+
+			VAL_PROFILE_SCOPE("SubmissionService::Drain");
+
+			// Take every request at once, and restore the push order (the list is LIFO)
+			requests.clear();
+			for (Request* request = m_head.exchange(nullptr, std::memory_order_acquire); request; request = request->next)
+			{
+				requests.emplace_back(request);
+			}
+
+			for (auto it = requests.rbegin(); it != requests.rend(); ++it)
+			{
+				Request& request = **it;
+
+				if (request.stop)
+				{
+					stop = true;
+				}
+				else if (request.task)
+				{
+					// Previous batches must reach the queue before the task uses it
+					flush(std::nullopt);
+
+					try
+					{
+						request.task(m_queue);
+						request.taskPromise.set_value();
+					}
+					catch (...)
+					{
+						request.taskPromise.set_exception(std::current_exception());
+					}
+				}
+				else
+				{
+					pendingBatch.Append(request.batch);
+					pendingRequests.push_back(&request);
+
+					// A submission only takes a single fence, signaled once every merged batch is complete
+					if (request.fence.has_value())
+					{
+						flush(request.fence);
+					}
+				}
+			}
+
+			flush(std::nullopt);
+		}
+	}
+}
@@ -0,0 +1,126 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/SubmitBatch.h>
+#include <val/CommandBuffer.h>
+#include <algorithm>
+
+namespace val
+{
+	SubmitBatch& SubmitBatch::AddSubmission()
+	{
+		m_submissions.emplace_back();
+		return *this;
+	}
+
+	SubmitBatch& SubmitBatch::AddCommandBuffer(CommandBuffer& p_commandBuffer)
+	{
+		GetCurrentSubmission().commandBuffers.push_back(VkCommandBufferSubmitInfo{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+			.commandBuffer = p_commandBuffer.GetHandle()
+		});
+
+		return *this;
+	}
+
+	SubmitBatch& SubmitBatch::Wait(sync::Semaphore& p_semaphore, VkPipelineStageFlags2 p_stages)
+	{
+		GetCurrentSubmission().waitSemaphores.push_back(VkSemaphoreSubmitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = p_semaphore.GetHandle(),
+			.stageMask = p_stages
+		});
+
+		return *this;
+	}
+
+	SubmitBatch& SubmitBatch::Wait(const sync::TimelineValue& p_value, VkPipelineStageFlags2 p_stages)
+	{
+		GetCurrentSubmission().waitSemaphores.push_back(VkSemaphoreSubmitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = p_value.semaphore.get().GetHandle(),
+			.value = p_value.value,
+			.stageMask = p_stages
+		});
+
+		return *this;
+	}
+
+	SubmitBatch& SubmitBatch::Signal(sync::Semaphore& p_semaphore, VkPipelineStageFlags2 p_stages)
+	{
+		GetCurrentSubmission().signalSemaphores.push_back(VkSemaphoreSubmitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = p_semaphore.GetHandle(),
+			.stageMask = p_stages
+		});
+
+		return *this;
+	}
+
+	SubmitBatch& SubmitBatch::Signal(const sync::TimelineValue& p_value, VkPipelineStageFlags2 p_stages)
+	{
+		GetCurrentSubmission().signalSemaphores.push_back(VkSemaphoreSubmitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = p_value.semaphore.get().GetHandle(),
+			.value = p_value.value,
+			.stageMask = p_stages
+		});
+
+		return *this;
+	}
+
+	SubmitBatch& SubmitBatch::Append(const SubmitBatch& p_other)
+	{
+		m_submissions.insert(m_submissions.end(), p_other.m_submissions.begin(), p_other.m_submissions.end());
+		return *this;
+	}
+
+	void SubmitBatch::Clear()
+	{
+		m_submissions.clear();
+	}
+
+	bool SubmitBatch::IsEmpty() const
+	{
+		return std::ranges::all_of(m_submissions, [](const Submission& p_submission) {
+			return
+				p_submission.waitSemaphores.empty() &&
+				p_submission.commandBuffers.empty() &&
+				p_submission.signalSemaphores.empty();
+		});
+	}
+
+	std::vector<VkSubmitInfo2> SubmitBatch::GetSubmitInfos() const
+	{
+		std::vector<VkSubmitInfo2> submitInfos;
+		submitInfos.reserve(m_submissions.size());
+
+		for (const auto& submission : m_submissions)
+		{
+			submitInfos.push_back(VkSubmitInfo2{
+				.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+				.waitSemaphoreInfoCount = static_cast<uint32_t>(submission.waitSemaphores.size()),
+				.pWaitSemaphoreInfos = submission.waitSemaphores.data(),
+				.commandBufferInfoCount = static_cast<uint32_t>(submission.commandBuffers.size()),
+				.pCommandBufferInfos = submission.commandBuffers.data(),
+				.signalSemaphoreInfoCount = static_cast<uint32_t>(submission.signalSemaphores.size()),
+				.pSignalSemaphoreInfos = submission.signalSemaphores.data()
+			});
+		}
+
+		return submitInfos;
+	}
+
+	SubmitBatch::Submission& SubmitBatch::GetCurrentSubmission()
+	{
+		if (m_submissions.empty())
+		{
+			AddSubmission();
+		}
+
+		return m_submissions.back();
+	}
+}
@@ -9,6 +9,7 @@
 #endif
 
 #include <val/Surface.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -18,6 +19,8 @@ namespace val
 	Surface::Surface(VkInstance p_instance, const SurfaceDesc& p_desc) :
 		m_instance(p_instance)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		assert((p_desc.windowHandle && p_desc.instanceHandle) && "incomplete surface desc");
 		
 #if defined(_WIN32) || defined(_WIN64)
@@ -6,6 +6,8 @@
 
 #include <val/SwapChain.h>
 #include <val/Device.h>
+#include <val/utils/CpuProfiler.h>
+#include <cassert>
 #include <stdexcept>
 
 namespace
@@ -32,13 +34,17 @@ namespace val
 	SwapChain::SwapChain(
 		Device& p_device,
 		VkSurfaceKHR p_surface,
-		const utils::SwapChainOptimalConfig& p_desc
+		const utils::SwapChainOptimalConfig& p_desc,
+		std::optional<std::reference_wrapper<SwapChain>> p_oldSwapChain
 	) :
 		m_device(p_device),
 		m_desc(p_desc)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		const auto& queueFamilyIndices = p_device.GetQueueFamilyIndices();
-		const auto indices = queueFamilyIndices.GetUniqueQueueIndices();
+		// Transfer and compute families never touch swap chain images, so they don't make them concurrent
+		const auto indices = queueFamilyIndices.GetPresentationQueueIndices();
 
 		VkSwapchainCreateInfoKHR createInfo{
 			.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -71,7 +77,7 @@ namespace val
 			.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
 			.presentMode = m_desc.presentMode,
 			.clipped = VK_TRUE,
-			.oldSwapchain = VK_NULL_HANDLE
+			.oldSwapchain = p_oldSwapChain.has_value() ? p_oldSwapChain->get().GetHandle() : VK_NULL_HANDLE
 		};
 
 		if (vkCreateSwapchainKHR(
@@ -123,6 +129,21 @@ namespace val
 				throw std::runtime_error("failed to create image views!");
 			}
 		}
+
+		// Wrap images (without taking ownership), so command buffers can track their layout
+		m_trackedImages.reserve(m_images.size());
+		for (auto image : m_images)
+		{
+			m_trackedImages.push_back(std::make_unique<Image>(
+				m_device,
+				image,
+				ImageDesc{
+					.extent = { m_desc.extent.width, m_desc.extent.height, 1 },
+					.format = m_desc.surfaceFormat.format,
+					.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+				}
+			));
+		}
 	}
 
 	SwapChain::~SwapChain()
@@ -146,6 +167,8 @@ namespace val
 		std::optional<uint64_t> p_timeout
 	)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		uint32_t imageIndex;
 
 		VkResult result = vkAcquireNextImageKHR(
@@ -175,6 +198,17 @@ namespace val
 		return m_images;
 	}
 
+	Image& SwapChain::GetImage(uint32_t p_index) const
+	{
+		assert(p_index < m_trackedImages.size());
+		return *m_trackedImages[p_index];
+	}
+
+	const std::vector<VkImageView>& SwapChain::GetImageViews() const
+	{
+		return m_imageViews;
+	}
+
 	const utils::SwapChainOptimalConfig& SwapChain::GetDesc() const
 	{
 		return m_desc;
@@ -182,6 +216,8 @@ namespace val
 
 	std::vector<val::Framebuffer> SwapChain::CreateFramebuffers(VkRenderPass p_renderPass)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		std::vector<val::Framebuffer> framebuffers;
 		framebuffers.reserve(m_imageViews.size());
 
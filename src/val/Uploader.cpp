@@ -0,0 +1,193 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/Uploader.h>
+#include <val/Device.h>
+#include <val/CommandBuffer.h>
+#include <val/utils/CpuProfiler.h>
+#include <array>
+#include <cassert>
+
+namespace val
+{
+	Uploader::Uploader(Device& p_device) :
+		m_device(p_device),
+		m_dedicatedTransferQueue(p_device.HasDedicatedTransferQueue()),
+		m_transferCommandPool(p_device, EQueueType::Transfer),
+		m_graphicsCommandPool(p_device, EQueueType::Graphics),
+		m_timeline(p_device.GetLogicalDevice())
+	{
+	}
+
+	Uploader::~Uploader()
+	{
+		// Command buffers must outlive the submissions using them
+		m_timeline.Wait(m_lastSignaledValue);
+
+		// Staging buffer deletions are keyed on this timeline, so they must not outlive it
+		m_device.GetDeletionQueue().Flush();
+	}
+
+	void Uploader::UploadBuffer(Buffer& p_dest, const void* p_data, uint64_t p_size, const sync::ResourceState& p_state)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_size <= p_dest.GetAllocatedBytes());
+
+		UploadBatch& batch = GetRecordingBatch();
+
+		auto& stagingBuffer = batch.stagingBuffers.emplace_back(std::make_unique<Buffer>(
+			m_device,
+			BufferDesc{
+				.size = p_size,
+				.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+			}
+		));
+
+		stagingBuffer->Allocate(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		stagingBuffer->Upload(p_data, BufferMemoryRange{ .offset = 0, .size = p_size });
+
+		// The previous content is discarded, and a transfer queue can't wait for stages of other queues
+		if (m_dedicatedTransferQueue)
+		{
+			p_dest.SetState({});
+		}
+
+		CommandBuffer& transferCommandBuffer = batch.transferCommandBuffer;
+		transferCommandBuffer.CopyBuffer(*stagingBuffer, p_dest, std::to_array<VkBufferCopy>({ { .size = p_size } }));
+
+		const uint32_t transferFamily = m_device.GetQueueFamilyIndex(EQueueType::Transfer);
+		const uint32_t graphicsFamily = m_device.GetQueueFamilyIndex(EQueueType::Graphics);
+
+		transferCommandBuffer.ReleaseBufferOwnership(p_dest, transferFamily, graphicsFamily);
+		batch.acquireCommandBuffer.get().AcquireBufferOwnership(p_dest, transferFamily, graphicsFamily, p_state);
+	}
+
+	sync::TimelineValue Uploader::Flush()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		if (!m_recordingBatch)
+		{
+			return { m_timeline, m_lastSignaledValue };
+		}
+
+		UploadBatch& batch = *m_recordingBatch;
+
+		batch.transferCommandBuffer.get().End();
+
+		// Staging buffers are only read by the transfer submission
+		uint64_t transferValue = 0;
+
+		if (m_dedicatedTransferQueue)
+		{
+			batch.acquireCommandBuffer.get().End();
+
+			transferValue = ++m_lastSignaledValue;
+			batch.completionValue = ++m_lastSignaledValue;
+
+			// Release on the transfer queue, then acquire on the graphics queue once the transfer is complete
+			m_device.GetTransferQueue().Submit(
+				std::to_array({ batch.transferCommandBuffer }),
+				{}, {},
+				{},
+				{ { m_timeline, transferValue } }
+			);
+
+			m_device.GetGraphicsQueue().Submit(
+				std::to_array({ batch.acquireCommandBuffer }),
+				{}, {},
+				{ { m_timeline, transferValue } },
+				{ { m_timeline, batch.completionValue } }
+			);
+		}
+		else
+		{
+			batch.completionValue = ++m_lastSignaledValue;
+			transferValue = batch.completionValue;
+
+			m_device.GetTransferQueue().Submit(
+				std::to_array({ batch.transferCommandBuffer }),
+				{}, {},
+				{},
+				{ { m_timeline, batch.completionValue } }
+			);
+		}
+
+		for (auto& stagingBuffer : batch.stagingBuffers)
+		{
+			m_device.GetDeletionQueue().Enqueue({ m_timeline, transferValue }, std::move(stagingBuffer));
+		}
+
+		batch.stagingBuffers.clear();
+
+		m_submittedBatches.push_back(std::move(batch));
+		m_recordingBatch.reset();
+
+		return { m_timeline, m_lastSignaledValue };
+	}
+
+	sync::TimelineSemaphore& Uploader::GetTimeline()
+	{
+		return m_timeline;
+	}
+
+	Uploader::UploadBatch& Uploader::GetRecordingBatch()
+	{
+		if (m_recordingBatch)
+		{
+			return *m_recordingBatch;
+		}
+
+		RecycleCompletedBatches();
+
+		if (!m_freeBatches.empty())
+		{
+			m_recordingBatch = std::make_unique<UploadBatch>(std::move(m_freeBatches.back()));
+			m_freeBatches.pop_back();
+		}
+		else
+		{
+			CommandBuffer& transferCommandBuffer = m_transferCommandPool.AllocateCommandBuffers(1).front();
+
+			m_recordingBatch = std::make_unique<UploadBatch>(UploadBatch{
+				.transferCommandBuffer = transferCommandBuffer,
+				.acquireCommandBuffer = m_dedicatedTransferQueue ?
+					m_graphicsCommandPool.AllocateCommandBuffers(1).front() :
+					std::ref(transferCommandBuffer)
+			});
+		}
+
+		m_recordingBatch->transferCommandBuffer.get().Reset();
+		m_recordingBatch->transferCommandBuffer.get().Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+		if (m_dedicatedTransferQueue)
+		{
+			m_recordingBatch->acquireCommandBuffer.get().Reset();
+			m_recordingBatch->acquireCommandBuffer.get().Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+		}
+
+		return *m_recordingBatch;
+	}
+
+	void Uploader::RecycleCompletedBatches()
+	{
+		const uint64_t completedValue = m_timeline.GetValue();
+
+		for (auto it = m_submittedBatches.begin(); it != m_submittedBatches.end();)
+		{
+			if (it->completionValue <= completedValue)
+			{
+				m_freeBatches.push_back(std::move(*it));
+				it = m_submittedBatches.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+}
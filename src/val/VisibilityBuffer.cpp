@@ -0,0 +1,85 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/VisibilityBuffer.h>
+#include <val/CommandBuffer.h>
+#include <val/QueryPool.h>
+#include <val/utils/CpuProfiler.h>
+#include <cassert>
+#include <vector>
+
+namespace val
+{
+	VisibilityBuffer::VisibilityBuffer(Device& p_device, uint32_t p_objectCount) :
+		m_objectCount(p_objectCount),
+		m_buffer(
+			p_device,
+			BufferDesc{
+				.size = p_objectCount * sizeof(uint32_t),
+				.usage =
+					VK_BUFFER_USAGE_CONDITIONAL_RENDERING_BIT_EXT |
+					VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+					VK_BUFFER_USAGE_TRANSFER_DST_BIT
+			}
+		)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_objectCount > 0);
+
+		// Host visible, so predicates can be initialized without a transfer
+		m_buffer.Allocate(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		const std::vector<uint32_t> visible(p_objectCount, 1);
+		m_buffer.Upload(visible.data());
+	}
+
+	void VisibilityBuffer::ResolveOcclusionQueries(
+		CommandBuffer& p_commandBuffer,
+		QueryPool& p_queryPool,
+		uint32_t p_firstQuery,
+		uint32_t p_queryCount,
+		uint32_t p_firstObject
+	)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		assert(p_queryPool.GetDesc().type == VK_QUERY_TYPE_OCCLUSION);
+		assert(p_firstObject + p_queryCount <= m_objectCount);
+
+		// 32-bit sample counts can be used as predicates directly (non-zero means visible)
+		p_commandBuffer.CopyQueryPoolResults(
+			p_queryPool,
+			p_firstQuery,
+			p_queryCount,
+			m_buffer,
+			GetOffset(p_firstObject),
+			sizeof(uint32_t),
+			VK_QUERY_RESULT_WAIT_BIT
+		);
+	}
+
+	void VisibilityBuffer::BeginConditionalRendering(CommandBuffer& p_commandBuffer, uint32_t p_object, bool p_inverted)
+	{
+		p_commandBuffer.BeginConditionalRendering(m_buffer, GetOffset(p_object), p_inverted);
+	}
+
+	uint64_t VisibilityBuffer::GetOffset(uint32_t p_object) const
+	{
+		assert(p_object < m_objectCount);
+		return p_object * sizeof(uint32_t);
+	}
+
+	uint32_t VisibilityBuffer::GetObjectCount() const
+	{
+		return m_objectCount;
+	}
+
+	Buffer& VisibilityBuffer::GetBuffer()
+	{
+		return m_buffer;
+	}
+}
@@ -0,0 +1,320 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/sync/BarrierBatch.h>
+#include <val/utils/CpuProfiler.h>
+#include <algorithm>
+#include <cassert>
+#include <optional>
+
+namespace
+{
+	constexpr VkAccessFlags2 k_writeAccessMask =
+		VK_ACCESS_2_SHADER_WRITE_BIT |
+		VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT |
+		VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_2_TRANSFER_WRITE_BIT |
+		VK_ACCESS_2_HOST_WRITE_BIT |
+		VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+	/**
+	* Source and destination scopes of a barrier required by a transition
+	*/
+	struct Dependency
+	{
+		VkPipelineStageFlags2 srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+		VkAccessFlags2 srcAccessMask = VK_ACCESS_2_NONE;
+		VkPipelineStageFlags2 dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+		VkAccessFlags2 dstAccessMask = VK_ACCESS_2_NONE;
+	};
+
+	/**
+	* Returns the state of a resource right after a barrier (or a queue family ownership transfer)
+	* synchronizing it with the target state.
+	*/
+	val::sync::ResourceState MakeSynchronizedState(const val::sync::ResourceState& p_targetState)
+	{
+		const bool isWrite = val::sync::BarrierBatch::IsWriteAccess(p_targetState.accessMask);
+
+		// Once synchronized, the next accesses only need to chain their execution dependency to the target
+		// stage: for a write, its own access still has to be made available, while for a read the previous
+		// write (or layout transition) is already visible to the target stage and access.
+		return val::sync::ResourceState{
+			.stageMask = p_targetState.stageMask,
+			.accessMask = p_targetState.accessMask,
+			.layout = p_targetState.layout,
+			.writeStageMask = p_targetState.stageMask,
+			.writeAccessMask = p_targetState.accessMask & k_writeAccessMask,
+			.visibleStageMask = isWrite ? VK_PIPELINE_STAGE_2_NONE : p_targetState.stageMask,
+			.visibleAccessMask = isWrite ? VK_ACCESS_2_NONE : p_targetState.accessMask
+		};
+	}
+
+	/**
+	* Updates the current state to the target state, and returns the barrier required between them, if any.
+	* Reads don't need to be synchronized with each other, but every read must see the last write: a read
+	* the last write hasn't been made visible to yet requires a barrier, even if the resource is already read
+	* by other stages. Writes (and layout transitions) wait for every access since the last write.
+	*/
+	std::optional<Dependency> Transition(
+		val::sync::ResourceState& p_currentState,
+		const val::sync::ResourceState& p_targetState,
+		bool p_layoutChange
+	)
+	{
+		const bool isWrite = val::sync::BarrierBatch::IsWriteAccess(p_targetState.accessMask);
+
+		if (p_layoutChange || isWrite)
+		{
+			const Dependency dependency{
+				.srcStageMask = p_currentState.stageMask | p_currentState.writeStageMask,
+				.srcAccessMask = p_currentState.writeAccessMask, // Only writes need to be made available
+				.dstStageMask = p_targetState.stageMask,
+				.dstAccessMask = p_targetState.accessMask
+			};
+
+			p_currentState = MakeSynchronizedState(p_targetState);
+
+			// A resource never used by the GPU doesn't need to be synchronized
+			if (!p_layoutChange && dependency.srcStageMask == VK_PIPELINE_STAGE_2_NONE)
+			{
+				return std::nullopt;
+			}
+
+			return dependency;
+		}
+
+		const bool isVisible =
+			(p_targetState.stageMask & ~p_currentState.visibleStageMask) == 0 &&
+			(p_targetState.accessMask & ~p_currentState.visibleAccessMask) == 0;
+
+		p_currentState.stageMask |= p_targetState.stageMask;
+		p_currentState.accessMask |= p_targetState.accessMask;
+
+		if (p_currentState.writeStageMask == VK_PIPELINE_STAGE_2_NONE || isVisible)
+		{
+			return std::nullopt;
+		}
+
+		p_currentState.visibleStageMask |= p_targetState.stageMask;
+		p_currentState.visibleAccessMask |= p_targetState.accessMask;
+
+		return Dependency{
+			.srcStageMask = p_currentState.writeStageMask,
+			.srcAccessMask = p_currentState.writeAccessMask,
+			.dstStageMask = p_targetState.stageMask,
+			.dstAccessMask = p_targetState.accessMask
+		};
+	}
+
+	/**
+	* Returns true if a pending barrier can be extended by later transitions of its resource. Ownership releases can't,
+	* since their destination scope is ignored (releases have no destination stage, the acquire defines it).
+	*/
+	template<class Barrier>
+	bool IsExtendable(const Barrier& p_barrier)
+	{
+		return
+			p_barrier.srcQueueFamilyIndex == p_barrier.dstQueueFamilyIndex ||
+			p_barrier.dstStageMask != VK_PIPELINE_STAGE_2_NONE;
+	}
+
+	/**
+	* Extends a pending barrier with a new dependency. No command used the resource since the pending
+	* barrier was requested, so the barrier can wait for, and be made visible to, both scopes at once.
+	*/
+	template<class Barrier>
+	void MergeDependency(Barrier& p_barrier, const Dependency& p_dependency)
+	{
+		p_barrier.srcStageMask |= p_dependency.srcStageMask;
+		p_barrier.srcAccessMask |= p_dependency.srcAccessMask;
+		p_barrier.dstStageMask |= p_dependency.dstStageMask;
+		p_barrier.dstAccessMask |= p_dependency.dstAccessMask;
+	}
+}
+
+namespace val::sync
+{
+	bool BarrierBatch::IsWriteAccess(VkAccessFlags2 p_accessMask)
+	{
+		return (p_accessMask & k_writeAccessMask) != 0;
+	}
+
+	bool BarrierBatch::AddBufferTransition(
+		VkBuffer p_buffer,
+		ResourceState& p_currentState,
+		const ResourceState& p_targetState,
+		VkDeviceSize p_offset,
+		VkDeviceSize p_size
+	)
+	{
+		const auto dependency = Transition(p_currentState, p_targetState, false);
+
+		if (!dependency.has_value())
+		{
+			return false;
+		}
+
+		// If a barrier is already pending for this buffer, it is extended rather than duplicated
+		auto pending = std::find_if(m_bufferBarriers.begin(), m_bufferBarriers.end(), [p_buffer](const auto& p_barrier) {
+			return p_barrier.buffer == p_buffer && IsExtendable(p_barrier);
+		});
+
+		if (pending != m_bufferBarriers.end())
+		{
+			MergeDependency(*pending, dependency.value());
+		}
+		else
+		{
+			m_bufferBarriers.push_back(VkBufferMemoryBarrier2{
+				.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+				.srcStageMask = dependency->srcStageMask,
+				.srcAccessMask = dependency->srcAccessMask,
+				.dstStageMask = dependency->dstStageMask,
+				.dstAccessMask = dependency->dstAccessMask,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.buffer = p_buffer,
+				.offset = p_offset,
+				.size = p_size
+			});
+		}
+
+		return true;
+	}
+
+	void BarrierBatch::AddBufferOwnershipTransfer(
+		VkBuffer p_buffer,
+		ResourceState& p_currentState,
+		const ResourceState& p_targetState,
+		uint32_t p_srcQueueFamilyIndex,
+		uint32_t p_dstQueueFamilyIndex
+	)
+	{
+		m_bufferBarriers.push_back(VkBufferMemoryBarrier2{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+			.srcStageMask = p_currentState.stageMask | p_currentState.writeStageMask,
+			.srcAccessMask = p_currentState.writeAccessMask,
+			.dstStageMask = p_targetState.stageMask,
+			.dstAccessMask = p_targetState.accessMask,
+			.srcQueueFamilyIndex = p_srcQueueFamilyIndex,
+			.dstQueueFamilyIndex = p_dstQueueFamilyIndex,
+			.buffer = p_buffer,
+			.offset = 0,
+			.size = VK_WHOLE_SIZE
+		});
+
+		p_currentState = MakeSynchronizedState(p_targetState);
+	}
+
+	void BarrierBatch::AddImageOwnershipTransfer(
+		VkImage p_image,
+		ResourceState& p_currentState,
+		const ResourceState& p_targetState,
+		const VkImageSubresourceRange& p_subresourceRange,
+		uint32_t p_srcQueueFamilyIndex,
+		uint32_t p_dstQueueFamilyIndex
+	)
+	{
+		m_imageBarriers.push_back(VkImageMemoryBarrier2{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+			.srcStageMask = p_currentState.stageMask | p_currentState.writeStageMask,
+			.srcAccessMask = p_currentState.writeAccessMask,
+			.dstStageMask = p_targetState.stageMask,
+			.dstAccessMask = p_targetState.accessMask,
+			.oldLayout = p_currentState.layout,
+			.newLayout = p_targetState.layout,
+			.srcQueueFamilyIndex = p_srcQueueFamilyIndex,
+			.dstQueueFamilyIndex = p_dstQueueFamilyIndex,
+			.image = p_image,
+			.subresourceRange = p_subresourceRange
+		});
+
+		p_currentState = MakeSynchronizedState(p_targetState);
+	}
+
+	bool BarrierBatch::AddImageTransition(
+		VkImage p_image,
+		ResourceState& p_currentState,
+		const ResourceState& p_targetState,
+		const VkImageSubresourceRange& p_subresourceRange
+	)
+	{
+		const VkImageLayout oldLayout = p_currentState.layout;
+		const bool layoutChange = oldLayout != p_targetState.layout;
+		const auto dependency = Transition(p_currentState, p_targetState, layoutChange);
+
+		if (!dependency.has_value())
+		{
+			return false;
+		}
+
+		auto pending = std::find_if(m_imageBarriers.begin(), m_imageBarriers.end(), [p_image](const auto& p_barrier) {
+			return p_barrier.image == p_image && IsExtendable(p_barrier);
+		});
+
+		if (pending != m_imageBarriers.end())
+		{
+			// The layouts of an ownership transfer must match between the release and the acquire
+			assert((pending->srcQueueFamilyIndex == pending->dstQueueFamilyIndex || pending->newLayout == p_targetState.layout) && "image layout changed after its ownership transfer");
+
+			MergeDependency(*pending, dependency.value());
+			pending->newLayout = p_targetState.layout;
+		}
+		else
+		{
+			m_imageBarriers.push_back(VkImageMemoryBarrier2{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask = dependency->srcStageMask,
+				.srcAccessMask = dependency->srcAccessMask,
+				.dstStageMask = dependency->dstStageMask,
+				.dstAccessMask = dependency->dstAccessMask,
+				.oldLayout = oldLayout,
+				.newLayout = p_targetState.layout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = p_image,
+				.subresourceRange = p_subresourceRange
+			});
+		}
+
+		return true;
+	}
+
+	bool BarrierBatch::IsEmpty() const
+	{
+		return m_bufferBarriers.empty() && m_imageBarriers.empty();
+	}
+
+	void BarrierBatch::Flush(VkCommandBuffer p_commandBuffer)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		if (IsEmpty())
+		{
+			return;
+		}
+
+		VkDependencyInfo dependencyInfo{
+			.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferBarriers.size()),
+			.pBufferMemoryBarriers = m_bufferBarriers.data(),
+			.imageMemoryBarrierCount = static_cast<uint32_t>(m_imageBarriers.size()),
+			.pImageMemoryBarriers = m_imageBarriers.data()
+		};
+
+		vkCmdPipelineBarrier2(p_commandBuffer, &dependencyInfo);
+
+		Clear();
+	}
+
+	void BarrierBatch::Clear()
+	{
+		m_bufferBarriers.clear();
+		m_imageBarriers.clear();
+	}
+}
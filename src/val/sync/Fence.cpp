@@ -5,6 +5,7 @@
 */
 
 #include <val/sync/Fence.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -14,6 +15,8 @@ namespace val::sync
 	Fence::Fence(VkDevice p_device, bool p_createSignaled) :
 		m_device(p_device)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		VkFenceCreateInfo createInfo{
 			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
 			.flags = p_createSignaled ? VK_FENCE_CREATE_SIGNALED_BIT : VkFenceCreateFlags{}
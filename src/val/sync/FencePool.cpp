@@ -0,0 +1,76 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/sync/FencePool.h>
+#include <val/utils/CpuProfiler.h>
+#include <stdexcept>
+
+namespace val::sync
+{
+	FencePool::FencePool(VkDevice p_device) :
+		m_device(p_device)
+	{
+	}
+
+	Fence& FencePool::Acquire()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::scoped_lock lock(m_mutex);
+
+		if (m_availableFences.empty())
+		{
+			RecycleSignaledFences();
+		}
+
+		if (m_availableFences.empty())
+		{
+			return *m_fences.emplace_back(std::make_unique<Fence>(m_device));
+		}
+
+		Fence* fence = m_availableFences.back();
+		m_availableFences.pop_back();
+		return *fence;
+	}
+
+	void FencePool::Release(Fence& p_fence)
+	{
+		std::scoped_lock lock(m_mutex);
+		m_releasedFences.push_back(&p_fence);
+	}
+
+	void FencePool::RecycleSignaledFences()
+	{
+		std::vector<VkFence> signaledFences;
+		signaledFences.reserve(m_releasedFences.size());
+
+		std::erase_if(m_releasedFences, [&](Fence* p_fence) {
+			if (vkGetFenceStatus(m_device, p_fence->GetHandle()) == VK_SUCCESS)
+			{
+				signaledFences.push_back(p_fence->GetHandle());
+				m_availableFences.push_back(p_fence);
+				return true;
+			}
+
+			return false;
+		});
+
+		if (signaledFences.empty())
+		{
+			return;
+		}
+
+		// Every signaled fence is reset at once
+		if (vkResetFences(
+			m_device,
+			static_cast<uint32_t>(signaledFences.size()),
+			signaledFences.data()
+		) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to reset fences!");
+		}
+	}
+}
@@ -5,6 +5,7 @@
 */
 
 #include <val/sync/Semaphore.h>
+#include <val/utils/CpuProfiler.h>
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
@@ -14,6 +15,8 @@ namespace val::sync
 	Semaphore::Semaphore(VkDevice p_device) :
 		m_device(p_device)
 	{
+		VAL_PROFILE_FUNCTION();
+
 		VkSemaphoreCreateInfo createInfo{
 			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
 		};
@@ -0,0 +1,66 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/sync/SemaphorePool.h>
+#include <val/utils/CpuProfiler.h>
+
+namespace val::sync
+{
+	SemaphorePool::SemaphorePool(VkDevice p_device) :
+		m_device(p_device)
+	{
+	}
+
+	Semaphore& SemaphorePool::Acquire()
+	{
+		VAL_PROFILE_FUNCTION();
+
+		std::scoped_lock lock(m_mutex);
+
+		if (m_availableSemaphores.empty())
+		{
+			RecycleRetiredSemaphores();
+		}
+
+		if (m_availableSemaphores.empty())
+		{
+			return *m_semaphores.emplace_back(std::make_unique<Semaphore>(m_device));
+		}
+
+		Semaphore* semaphore = m_availableSemaphores.back();
+		m_availableSemaphores.pop_back();
+		return *semaphore;
+	}
+
+	void SemaphorePool::Release(Semaphore& p_semaphore, std::optional<TimelineValue> p_retireValue)
+	{
+		std::scoped_lock lock(m_mutex);
+
+		if (p_retireValue.has_value())
+		{
+			m_releasedSemaphores.push_back({ &p_semaphore, p_retireValue.value() });
+		}
+		else
+		{
+			m_availableSemaphores.push_back(&p_semaphore);
+		}
+	}
+
+	void SemaphorePool::RecycleRetiredSemaphores()
+	{
+		TimelineValueChecker checker;
+
+		std::erase_if(m_releasedSemaphores, [&](const ReleasedSemaphore& p_released) {
+			if (checker.IsReached(p_released.retireValue))
+			{
+				m_availableSemaphores.push_back(p_released.semaphore);
+				return true;
+			}
+
+			return false;
+		});
+	}
+}
@@ -0,0 +1,112 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/sync/TimelineSemaphore.h>
+#include <val/utils/CpuProfiler.h>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace val::sync
+{
+	TimelineSemaphore::TimelineSemaphore(VkDevice p_device, uint64_t p_initialValue) :
+		m_device(p_device)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		VkSemaphoreTypeCreateInfo typeCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue = p_initialValue
+		};
+
+		VkSemaphoreCreateInfo createInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &typeCreateInfo
+		};
+
+		if (vkCreateSemaphore(m_device, &createInfo, nullptr, &m_handle) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create timeline semaphore!");
+		}
+	}
+
+	TimelineSemaphore::~TimelineSemaphore()
+	{
+		vkDestroySemaphore(m_device, m_handle, nullptr);
+	}
+
+	void TimelineSemaphore::Signal(uint64_t p_value)
+	{
+		VAL_PROFILE_FUNCTION();
+
+		VkSemaphoreSignalInfo signalInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SIGNAL_INFO,
+			.semaphore = m_handle,
+			.value = p_value
+		};
+
+		if (vkSignalSemaphore(m_device, &signalInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to signal timeline semaphore!");
+		}
+	}
+
+	bool TimelineSemaphore::Wait(uint64_t p_value, std::optional<uint64_t> p_timeout) const
+	{
+		VAL_PROFILE_FUNCTION();
+
+		VkSemaphoreWaitInfo waitInfo{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores = &m_handle,
+			.pValues = &p_value
+		};
+
+		const VkResult result = vkWaitSemaphores(
+			m_device,
+			&waitInfo,
+			p_timeout.value_or(std::numeric_limits<uint64_t>::max())
+		);
+
+		if (result != VK_SUCCESS && result != VK_TIMEOUT)
+		{
+			throw std::runtime_error("failed to wait for timeline semaphore!");
+		}
+
+		return result == VK_SUCCESS;
+	}
+
+	uint64_t TimelineSemaphore::GetValue() const
+	{
+		uint64_t value = 0;
+
+		if (vkGetSemaphoreCounterValue(m_device, m_handle, &value) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to get timeline semaphore value!");
+		}
+
+		return value;
+	}
+
+	VkSemaphore TimelineSemaphore::GetHandle() const
+	{
+		return m_handle;
+	}
+
+	bool TimelineValueChecker::IsReached(const TimelineValue& p_value)
+	{
+		const TimelineSemaphore& timeline = p_value.semaphore;
+
+		if (&timeline != m_lastTimeline)
+		{
+			m_lastTimeline = &timeline;
+			m_lastTimelineValue = timeline.GetValue();
+		}
+
+		return m_lastTimelineValue >= p_value.value;
+	}
+}
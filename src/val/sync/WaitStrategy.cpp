@@ -0,0 +1,56 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/sync/WaitStrategy.h>
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+namespace val::sync
+{
+	void WaitHistogram::Record(uint64_t p_durationNs, bool p_blocked)
+	{
+		// Bucket i holds durations in [2^(i-1), 2^i) microseconds
+		const uint64_t durationUs = p_durationNs / 1000;
+		const uint32_t bucket = std::min(static_cast<uint32_t>(std::bit_width(durationUs)), k_bucketCount - 1);
+
+		m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		(p_blocked ? m_blockedCount : m_spinCompletedCount).fetch_add(1, std::memory_order_relaxed);
+	}
+
+	uint64_t WaitHistogram::GetBucket(uint32_t p_index) const
+	{
+		assert(p_index < k_bucketCount);
+		return m_buckets[p_index].load(std::memory_order_relaxed);
+	}
+
+	uint64_t WaitHistogram::GetBucketUpperBoundNs(uint32_t p_index)
+	{
+		assert(p_index < k_bucketCount);
+		return (1ULL << p_index) * 1000;
+	}
+
+	uint64_t WaitHistogram::GetSpinCompletedCount() const
+	{
+		return m_spinCompletedCount.load(std::memory_order_relaxed);
+	}
+
+	uint64_t WaitHistogram::GetBlockedCount() const
+	{
+		return m_blockedCount.load(std::memory_order_relaxed);
+	}
+
+	void WaitHistogram::Reset()
+	{
+		for (auto& bucket : m_buckets)
+		{
+			bucket.store(0, std::memory_order_relaxed);
+		}
+
+		m_spinCompletedCount.store(0, std::memory_order_relaxed);
+		m_blockedCount.store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,178 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/utils/CpuProfiler.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	struct ProfilerEvent
+	{
+		const char* name;
+		uint64_t start;
+		uint64_t end;
+	};
+
+	// Only written by its owning thread. Readers use the write count to detect overwritten events.
+	struct ThreadRing
+	{
+		uint32_t threadIndex;
+		std::array<ProfilerEvent, val::utils::CpuProfiler::k_ringSize> events;
+		std::atomic<uint64_t> writeCount = 0;
+	};
+
+	// Rings are kept alive after their thread exits, so their events can still be exported
+	struct RingRegistry
+	{
+		std::mutex mutex;
+		std::vector<std::shared_ptr<ThreadRing>> rings;
+	};
+
+	RingRegistry& GetRegistry()
+	{
+		static RingRegistry registry;
+		return registry;
+	}
+
+	ThreadRing& GetThreadRing()
+	{
+		thread_local std::shared_ptr<ThreadRing> ring = [] {
+			auto output = std::make_shared<ThreadRing>();
+
+			RingRegistry& registry = GetRegistry();
+			std::scoped_lock lock(registry.mutex);
+			output->threadIndex = static_cast<uint32_t>(registry.rings.size());
+			registry.rings.push_back(output);
+
+			return output;
+		}();
+
+		return *ring;
+	}
+}
+
+namespace val::utils
+{
+	CpuProfiler::Scope::Scope(const char* p_name) :
+		m_name(p_name),
+		m_start(Now())
+	{
+	}
+
+	CpuProfiler::Scope::~Scope()
+	{
+		Record(m_name, m_start, Now());
+	}
+
+	void CpuProfiler::Record(const char* p_name, uint64_t p_start, uint64_t p_end)
+	{
+		ThreadRing& ring = GetThreadRing();
+
+		const uint64_t index = ring.writeCount.load(std::memory_order_relaxed);
+		ring.events[index % k_ringSize] = { p_name, p_start, p_end };
+		ring.writeCount.store(index + 1, std::memory_order_release);
+	}
+
+	uint64_t CpuProfiler::Now()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()
+		).count());
+	}
+
+	std::string CpuProfiler::ExportChromeTrace()
+	{
+		std::vector<std::shared_ptr<ThreadRing>> rings;
+
+		{
+			RingRegistry& registry = GetRegistry();
+			std::scoped_lock lock(registry.mutex);
+			rings = registry.rings;
+		}
+
+		std::ostringstream stream;
+		stream << std::fixed << std::setprecision(3); // Microseconds, without scientific notation
+		stream << "{\"traceEvents\":[";
+
+		bool first = true;
+		std::vector<ProfilerEvent> events;
+
+		for (const auto& ring : rings)
+		{
+			const uint64_t endIndex = ring->writeCount.load(std::memory_order_acquire);
+			const uint64_t beginIndex = endIndex > k_ringSize ? endIndex - k_ringSize : 0;
+
+			events.clear();
+			for (uint64_t i = beginIndex; i < endIndex; ++i)
+			{
+				events.push_back(ring->events[i % k_ringSize]);
+			}
+
+			// Events written by the owning thread during the copy may have overwritten the oldest copied events
+			const uint64_t newEndIndex = ring->writeCount.load(std::memory_order_acquire);
+			const uint64_t firstValidIndex = newEndIndex > k_ringSize ? newEndIndex - k_ringSize + 1 : 0;
+
+			for (uint64_t i = beginIndex; i < endIndex; ++i)
+			{
+				if (i < firstValidIndex)
+				{
+					continue;
+				}
+
+				const ProfilerEvent& event = events[i - beginIndex];
+
+				stream << (first ? "" : ",") << "{\"name\":\"";
+				stream << EscapeJson(event.name);
+				stream << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1"
+					<< ",\"tid\":" << ring->threadIndex
+					<< ",\"ts\":" << static_cast<double>(event.start) / 1000.0
+					<< ",\"dur\":" << static_cast<double>(event.end - event.start) / 1000.0
+					<< "}";
+
+				first = false;
+			}
+		}
+
+		stream << "],\"displayTimeUnit\":\"ms\"}";
+
+		return stream.str();
+	}
+
+	std::string CpuProfiler::EscapeJson(std::string_view p_value)
+	{
+		std::string output;
+		output.reserve(p_value.size());
+
+		for (const char c : p_value)
+		{
+			if (c == '"' || c == '\\')
+			{
+				output.push_back('\\');
+				output.push_back(c);
+			}
+			else if (static_cast<unsigned char>(c) < 0x20)
+			{
+				// Control characters can't appear raw in JSON strings
+				std::ostringstream stream;
+				stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c);
+				output += stream.str();
+			}
+			else
+			{
+				output.push_back(c);
+			}
+		}
+
+		return output;
+	}
+}
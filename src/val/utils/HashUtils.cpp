@@ -0,0 +1,25 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/utils/HashUtils.h>
+
+namespace val::utils
+{
+	uint64_t HashUtils::HashBytes(std::span<const std::byte> p_bytes, uint64_t p_seed)
+	{
+		constexpr uint64_t k_prime = 1099511628211ull;
+
+		uint64_t hash = p_seed;
+
+		for (const std::byte byte : p_bytes)
+		{
+			hash ^= static_cast<uint64_t>(byte);
+			hash *= k_prime;
+		}
+
+		return hash;
+	}
+}
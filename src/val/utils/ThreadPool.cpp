@@ -0,0 +1,75 @@
+/**
+* @project: vulkan-sandbox
+* @author: Adrien Givry
+* @licence: MIT
+*/
+
+#include <val/utils/ThreadPool.h>
+#include <algorithm>
+
+namespace val::utils
+{
+	ThreadPool::ThreadPool(uint32_t p_threadCount)
+	{
+		const uint32_t threadCount = p_threadCount > 0 ?
+			p_threadCount :
+			std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		m_threads.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; ++i)
+		{
+			m_threads.emplace_back([this] { Run(); });
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_stopping = true;
+		}
+
+		m_condition.notify_all();
+
+		// Workers exit once the queue is drained, and are joined by std::jthread
+		m_threads.clear();
+	}
+
+	void ThreadPool::Enqueue(Task p_task)
+	{
+		{
+			std::scoped_lock lock(m_mutex);
+			m_tasks.push_back(std::move(p_task));
+		}
+
+		m_condition.notify_one();
+	}
+
+	uint32_t ThreadPool::GetThreadCount() const
+	{
+		return static_cast<uint32_t>(m_threads.size());
+	}
+
+	void ThreadPool::Run()
+	{
+		while (true)
+		{
+			Task task;
+
+			{
+				std::unique_lock lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+
+				if (m_tasks.empty())
+				{
+					return;
+				}
+
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+
+			task();
+		}
+	}
+}